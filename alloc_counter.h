@@ -0,0 +1,17 @@
+// alloc_counter.h
+// Count of global operator new calls, used to check that the steady-state
+// frame loop does not allocate. The counting operator new lives in
+// alloc_counter.cpp and is only compiled into builds without NDEBUG; release
+// builds keep the default allocator and allocationCount() stays 0.
+
+#pragma once
+
+#include <cstdint>
+
+#ifdef NDEBUG
+constexpr bool allocationCountingEnabled = false;
+#else
+constexpr bool allocationCountingEnabled = true;
+#endif
+
+uint64_t allocationCount();
@@ -0,0 +1,257 @@
+// arena.h
+// Many snakes on one board. All bodies share a single OccupancyGrid plus an
+// owner grid (which snake, or food, is on each cell), so a tick resolves
+// every head against every body and against the other heads with a few grid
+// lookups per snake: O(snakes) per tick however long the snakes get. Only a
+// death costs its snake's length, to clear the body off the grid.
+// Moves are simultaneous: tails that move this tick are vacated first, so a
+// head may follow any tail, and two heads entering one cell both die.
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "game_state.h"
+
+struct ArenaConfig {
+    int snakes = 8;
+    int foods = 0;               // food items on the board at once, 0 = one per two snakes
+    int startLength = 4;         // at least 2
+    uint32_t respawnTicks = 20;  // a dead snake comes back after this long, 0 = never
+};
+
+struct ArenaSnake {
+    SnakeBody body; // front is head
+    Vec2i dir{1, 0};
+    Vec2i prevTail;
+    bool growNext = false;
+    bool alive = false;
+    int score = 0;          // this life
+    uint32_t kills = 0;     // snakes that ran into this one, over all lives
+    uint32_t deaths = 0;
+    uint32_t respawnIn = 0; // ticks until a dead snake is placed again
+    StepResult last = StepResult::Moved;
+};
+
+class ArenaState {
+public:
+    static constexpr uint16_t noOwner = 0;
+    static constexpr uint16_t foodMark = 0xffff;
+    static constexpr int maxSnakes = foodMark - 1;
+
+    GameConfig cfg;
+    ArenaConfig opts;
+    RNG rng;
+    std::vector<ArenaSnake> snakes;
+    std::vector<Vec2i> foods; // {-1, -1} when the board had no room for it
+    uint64_t tick = 0;
+
+    ArenaState(const GameConfig& config, const ArenaConfig& options) : cfg(config), opts(options), rng(config.seed, config.rngKind) {
+        opts.snakes = std::min(std::max(opts.snakes, 1), maxSnakes);
+        opts.startLength = std::max(opts.startLength, 2);
+        if (opts.foods <= 0) opts.foods = std::max(1, opts.snakes / 2);
+        reset();
+    }
+
+    // new round: every snake placed afresh, scores and kills cleared
+    void reset() {
+        grid.reset(cfg.cols, cfg.rows);
+        owner.assign((size_t)cfg.cols * cfg.rows, noOwner);
+        tick = 0;
+        snakes.resize((size_t)opts.snakes);
+        for (size_t i = 0; i < snakes.size(); ++i) {
+            ArenaSnake& s = snakes[i];
+            s.body.reserve(64);
+            s.alive = false;
+            s.kills = 0;
+            s.deaths = 0;
+            s.respawnIn = 0;
+            spawn(i);
+        }
+        foods.assign((size_t)opts.foods, Vec2i(-1, -1));
+        foodRanks.reserve(foods.size());
+        for (size_t k = 0; k < foods.size(); ++k) placeFood(k);
+    }
+
+    const OccupancyGrid& occupancy() const { return grid; }
+    bool occupied(Vec2i p) const { return grid.count(p) > 0; }
+    bool hasFood(Vec2i p) const { return grid.inBounds(p) && owner[cell(p)] == foodMark; }
+
+    // 1 + index of the snake on p, or noOwner (also for food)
+    uint16_t ownerAt(Vec2i p) const {
+        if (!grid.inBounds(p)) return noOwner;
+        uint16_t o = owner[cell(p)];
+        return o == foodMark ? noOwner : o;
+    }
+
+    size_t aliveCount() const {
+        size_t n = 0;
+        for (const ArenaSnake& s : snakes) n += s.alive;
+        return n;
+    }
+
+    // one tick for every snake; actions[i] steers snake i (None keeps going)
+    void step(const Action* actions) {
+        ++tick;
+        targets.resize(snakes.size());
+
+        // steer, and vacate the tails that move this tick
+        for (size_t i = 0; i < snakes.size(); ++i) {
+            ArenaSnake& s = snakes[i];
+            if (!s.alive) continue;
+            Vec2i d = directionOf(actions[i]);
+            if (actions[i] != Action::None && d != Vec2i(-s.dir.x, -s.dir.y)) s.dir = d;
+            s.prevTail = s.body.back();
+            if (!s.growNext) {
+                vacate(s.body.back());
+                s.body.pop_back();
+            }
+            s.growNext = false;
+        }
+
+        // where each head goes and what is already there; heads entering
+        // together are found after they are all in place
+        for (size_t i = 0; i < snakes.size(); ++i) {
+            ArenaSnake& s = snakes[i];
+            if (!s.alive) continue;
+            Target& t = targets[i];
+            const Vec2i h = t.head = s.body.front() + s.dir;
+            t.killer = -1;
+            if (!grid.inBounds(h)) {
+                t.result = StepResult::HitWall;
+            } else if (grid.count(h) > 0) {
+                const int hit = owner[cell(h)] - 1;
+                t.result = hit == (int)i ? StepResult::HitSelf : StepResult::HitSnake;
+                if (hit != (int)i) t.killer = hit;
+            } else {
+                t.result = owner[cell(h)] == foodMark ? StepResult::Ate : StepResult::Moved;
+            }
+        }
+        for (size_t i = 0; i < snakes.size(); ++i) {
+            ArenaSnake& s = snakes[i];
+            if (!s.alive) continue;
+            s.body.push_front(targets[i].head);
+            occupy(targets[i].head, i);
+        }
+        for (size_t i = 0; i < snakes.size(); ++i) {
+            Target& t = targets[i];
+            if (!snakes[i].alive || (t.result != StepResult::Moved && t.result != StepResult::Ate)) continue;
+            if (grid.count(t.head) > 1) t.result = StepResult::HitSnake; // head on head: both die, no kill
+        }
+
+        // clear the dead off the board, then feed the survivors
+        for (size_t i = 0; i < snakes.size(); ++i) {
+            ArenaSnake& s = snakes[i];
+            if (!s.alive) continue;
+            s.last = targets[i].result;
+            if (s.last == StepResult::Moved || s.last == StepResult::Ate) continue;
+            kill(i);
+            if (targets[i].killer >= 0) ++snakes[(size_t)targets[i].killer].kills;
+        }
+        for (size_t i = 0; i < snakes.size(); ++i) {
+            ArenaSnake& s = snakes[i];
+            if (!s.alive || s.last != StepResult::Ate) continue;
+            const Vec2i h = s.body.front();
+            owner[cell(h)] = (uint16_t)(i + 1);
+            s.growNext = true;
+            s.score += 10;
+            for (size_t k = 0; k < foods.size(); ++k)
+                if (foods[k] == h) placeFood(k);
+        }
+
+        // bring back the dead whose time is up; a crowded board tries again next tick
+        for (size_t i = 0; i < snakes.size(); ++i) {
+            ArenaSnake& s = snakes[i];
+            if (s.alive || opts.respawnTicks == 0 || s.respawnIn == 0) continue;
+            if (--s.respawnIn == 0 && !spawn(i)) s.respawnIn = 1;
+        }
+        // food that found no room earlier
+        for (size_t k = 0; k < foods.size(); ++k)
+            if (foods[k].x < 0) placeFood(k);
+    }
+
+private:
+    struct Target {
+        Vec2i head;
+        StepResult result;
+        int killer; // snake whose body or head was hit, -1 for none
+    };
+
+    size_t cell(Vec2i p) const { return (size_t)p.y * cfg.cols + p.x; }
+
+    void occupy(Vec2i p, size_t i) {
+        if (!grid.inBounds(p)) return;
+        grid.add(p);
+        if (owner[cell(p)] == noOwner) owner[cell(p)] = (uint16_t)(i + 1);
+    }
+
+    // food under a dead head stays food
+    void vacate(Vec2i p) {
+        if (!grid.inBounds(p)) return;
+        grid.remove(p);
+        if (grid.count(p) == 0 && owner[cell(p)] != foodMark) owner[cell(p)] = noOwner;
+    }
+
+    void kill(size_t i) {
+        ArenaSnake& s = snakes[i];
+        for (size_t k = 0; k < s.body.size(); ++k) vacate(s.body[k]);
+        s.body.clear();
+        s.alive = false;
+        ++s.deaths;
+        s.respawnIn = opts.respawnTicks;
+    }
+
+    bool freeCell(Vec2i p) const { return grid.inBounds(p) && grid.count(p) == 0 && owner[cell(p)] != foodMark; }
+
+    // lay snake i out straight on a random free stretch of the board, with
+    // room to move ahead; false when a few tries found none
+    bool spawn(size_t i) {
+        ArenaSnake& s = snakes[i];
+        const int len = opts.startLength;
+        for (int attempt = 0; attempt < 32 && grid.freeCount() > (size_t)len; ++attempt) {
+            Vec2i head = grid.freeCell((size_t)rng.nextInt(0, (int)grid.freeCount() - 1));
+            Vec2i d = directionOf((Action)rng.nextInt(1, 4));
+            bool fits = freeCell(head + d);
+            for (int k = 0; fits && k < len; ++k) fits = freeCell(head - d * k);
+            if (!fits) continue;
+            s.body.clear();
+            for (int k = 0; k < len; ++k) {
+                s.body.push_back(head - d * k);
+                occupy(s.body.back(), i);
+            }
+            s.dir = d;
+            s.prevTail = s.body.back();
+            s.growNext = false;
+            s.alive = true;
+            s.score = 0;
+            s.last = StepResult::Moved;
+            return true;
+        }
+        return false;
+    }
+
+    // food k to a random free cell without food; off the board if there is
+    // none. One draw over the free cells minus the other food, mapped into
+    // the grid's free-cell order by stepping over the food cells' ranks
+    void placeFood(size_t k) {
+        if (foods[k].x >= 0 && owner[cell(foods[k])] == foodMark) owner[cell(foods[k])] = noOwner;
+        foods[k] = Vec2i(-1, -1);
+        foodRanks.clear();
+        for (Vec2i f : foods)
+            if (f.x >= 0 && grid.count(f) == 0) foodRanks.push_back(grid.freeRank(f));
+        if (grid.freeCount() <= foodRanks.size()) return;
+        std::sort(foodRanks.begin(), foodRanks.end());
+        size_t n = (size_t)rng.nextInt(0, (int)(grid.freeCount() - foodRanks.size()) - 1);
+        for (size_t r : foodRanks) n += r <= n;
+        const Vec2i p = grid.freeCell(n);
+        foods[k] = p;
+        owner[cell(p)] = foodMark;
+    }
+
+    OccupancyGrid grid;
+    std::vector<uint16_t> owner; // per cell: noOwner, 1 + snake index, or foodMark
+    std::vector<Target> targets; // per snake, this tick
+    std::vector<size_t> foodRanks; // placeFood() scratch: free-order ranks of the other food
+};
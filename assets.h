@@ -0,0 +1,45 @@
+// assets.h
+// Assets built into the binary: resources/font.otf is turned into a byte
+// array at build time (resources/embed.cmake) and opened straight from
+// memory, once per process, so startup never probes the filesystem for a
+// font. prewarm() rasterizes the glyphs the HUD and overlay draw up front,
+// so the first frames don't stall on them either.
+
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <cstddef>
+#include <initializer_list>
+
+// defined in the generated embedded_font.cpp
+extern const unsigned char embeddedFontData[];
+extern const std::size_t embeddedFontSize;
+
+class Assets {
+public:
+    // the process-wide instance, loaded on first use
+    static Assets& get() {
+        static Assets assets;
+        return assets;
+    }
+
+    const sf::Font& font() const { return uiFont; }
+    bool fontLoaded() const { return loaded; }
+
+    // printable ASCII at each character size, into the font's glyph pages
+    void prewarm(std::initializer_list<unsigned> sizes) {
+        if (!loaded) return;
+        for (unsigned size : sizes)
+            for (char32_t c = 32; c < 127; ++c) (void)uiFont.getGlyph(c, size, false);
+    }
+
+    Assets(const Assets&) = delete;
+    Assets& operator=(const Assets&) = delete;
+
+private:
+    // openFromMemory keeps reading the buffer, which lives as long as the program
+    Assets() : loaded(uiFont.openFromMemory(embeddedFontData, embeddedFontSize)) {}
+
+    sf::Font uiFont;
+    bool loaded;
+};
@@ -0,0 +1,168 @@
+// autopilot.h
+// Pathfinding player: breadth-first search from the head to the food over the
+// occupancy grid, falling back to chasing its own tail when the food is out of
+// reach or eating it would leave the snake boxed in.
+// A path found to the food stays valid while the snake walks it (the body only
+// ever enters cells the path already passed), so it is cached and followed
+// without searching again until the food moves. Search buffers are sized once
+// per board and reset with a stamp instead of being cleared.
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <vector>
+
+#include "game_state.h"
+
+class Autopilot {
+public:
+    // forget the cached path, e.g. after a restart
+    void clear() {
+        path.clear();
+        next = 0;
+    }
+
+    // searches run so far, for benchmarks
+    uint64_t searches() const { return searchCount; }
+
+    // size the buffers for a board; decide() does it too, this just lets a
+    // caller do the allocation up front
+    void prepare(int newCols, int newRows) {
+        if (newCols == cols && newRows == rows) return;
+        cols = newCols;
+        rows = newRows;
+        size_t n = (size_t)cols * rows;
+        seen.assign(n, 0);
+        marked.assign(n, 0);
+        from.assign(n, 0);
+        queue.assign(n, 0);
+        path.clear();
+        path.reserve(n);
+        seenStamp = 0;
+        markStamp = 0;
+    }
+
+    Action decide(const GameState& g) {
+        prepare(g.cfg.cols, g.cfg.rows);
+        const Snake& snake = g.snake;
+        const Vec2i head = snake.head();
+        const Vec2i tail = snake.body.back();
+        const bool tailMoves = !snake.growNext;
+        auto blocked = [&](Vec2i p) { return snake.occupies(p) && !(tailMoves && p == tail); };
+
+        // keep walking the cached path: to this food, or a stretch of a path
+        // to the tail, after which the food is tried again
+        if (next < path.size() && (chasingTail ? next < tailStretch : pathFood == g.food) && isStep(head, path[next]) &&
+            !blocked(path[next]))
+            return step(head, path[next++]);
+
+        clear();
+        chasingTail = false;
+        if (search(head, g.food, blocked) && safeAfterEating(g)) {
+            pathFood = g.food;
+            return step(head, path[next++]);
+        }
+
+        // safety fallback: follow the tail, which keeps a way out open. The
+        // cells on the way were free when it was found and only the head
+        // enters new cells, so it stays walkable as the tail moves on ahead.
+        clear();
+        if (tailMoves && snake.body.size() > 1 && search(head, tail, blocked)) {
+            chasingTail = true;
+            return step(head, path[next++]);
+        }
+        // boxed in: any move that survives this tick
+        clear();
+        for (Action a : {Action::Up, Action::Down, Action::Left, Action::Right}) {
+            Vec2i q = head + directionOf(a);
+            if (q != head - snake.dir && snake.occupancy().inBounds(q) && !blocked(q)) return a;
+        }
+        return Action::None;
+    }
+
+private:
+    static bool isStep(Vec2i a, Vec2i b) { return std::abs(a.x - b.x) + std::abs(a.y - b.y) == 1; }
+    static Action step(Vec2i from, Vec2i to) { return actionFor(to - from); }
+
+    int cell(Vec2i p) const { return p.y * cols + p.x; }
+    Vec2i pos(int c) const { return {c % cols, c / cols}; }
+
+    void newStamp(std::vector<uint32_t>& stamps, uint32_t& stamp) {
+        if (++stamp == 0) {
+            // wrapped after 2^32 searches: clear once and start over
+            std::fill(stamps.begin(), stamps.end(), 0);
+            stamp = 1;
+        }
+    }
+
+    // BFS from start to goal over cells that are on the board and not
+    // blocked; with a path to fill it gets the cells after start, goal last
+    template <class Blocked>
+    bool search(Vec2i start, Vec2i goal, Blocked blocked, bool fillPath = true) {
+        static constexpr int dx[4] = {0, 0, -1, 1};
+        static constexpr int dy[4] = {-1, 1, 0, 0};
+        ++searchCount;
+        newStamp(seen, seenStamp);
+        const int goalCell = cell(goal);
+        size_t headIdx = 0, tailIdx = 0;
+        int s = cell(start);
+        seen[s] = seenStamp;
+        queue[tailIdx++] = s;
+        while (headIdx < tailIdx) {
+            int c = queue[headIdx++];
+            Vec2i p = pos(c);
+            for (int d = 0; d < 4; ++d) {
+                Vec2i q(p.x + dx[d], p.y + dy[d]);
+                if (q.x < 0 || q.x >= cols || q.y < 0 || q.y >= rows) continue;
+                int qc = cell(q);
+                if (seen[qc] == seenStamp || (qc != goalCell && blocked(q))) continue;
+                seen[qc] = seenStamp;
+                from[qc] = c;
+                if (qc == goalCell) {
+                    if (!fillPath) return true;
+                    for (int at = goalCell; at != s; at = from[at]) path.push_back(pos(at));
+                    std::reverse(path.begin(), path.end());
+                    return true;
+                }
+                queue[tailIdx++] = qc;
+            }
+        }
+        return false;
+    }
+
+    // lay the snake along path as it will be on reaching the food, then check
+    // that its head can still get back to its tail from there
+    bool safeAfterEating(const GameState& g) {
+        const SnakeBody& body = g.snake.body;
+        const size_t len = body.size();
+        const size_t steps = path.size();
+        if (len + 1 >= (size_t)cols * rows) return true; // the last meal wins the game
+        newStamp(marked, markStamp);
+        // new body, head first: the path backwards, then what is left of the old body
+        Vec2i newTail;
+        for (size_t i = 0; i < len; ++i) {
+            newTail = i < steps ? path[steps - 1 - i] : body[i - steps];
+            marked[cell(newTail)] = markStamp;
+        }
+        marked[cell(newTail)] = 0;
+        return search(g.food, newTail, [&](Vec2i p) { return marked[cell(p)] == markStamp; }, false);
+    }
+
+    int cols = 0;
+    int rows = 0;
+    std::vector<uint32_t> seen;   // == seenStamp: visited by the current search
+    std::vector<uint32_t> marked; // == markStamp: body cell in the safety check
+    std::vector<int> from;        // BFS parent cell
+    std::vector<int> queue;
+    uint32_t seenStamp = 0;
+    uint32_t markStamp = 0;
+    uint64_t searchCount = 0;
+
+    std::vector<Vec2i> path; // cells to walk, next one at path[next]
+    size_t next = 0;
+    Vec2i pathFood{-1, -1};
+    bool chasingTail = false;
+    static constexpr size_t tailStretch = 16; // tail-path steps before looking for the food again
+};
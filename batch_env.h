@@ -0,0 +1,217 @@
+// batch_env.h
+// K independent snake games stored structure-of-arrays and stepped together,
+// for agent training. Rules match GameState::step(); each environment owns an
+// RNG stream picked by GameConfig::seed and its index, so results don't depend
+// on the thread count.
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "bits.h"
+#include "game_state.h"
+#include "thread_pool.h"
+
+struct BatchEnvOptions {
+    bool autoReset = true;    // finished environments restart on their next step
+    uint32_t starveTicks = 0; // end an episode after this many ticks without food (0 = never)
+};
+
+class BatchEnv {
+public:
+    BatchEnv(const GameConfig& cfg, size_t count, BatchEnvOptions options = BatchEnvOptions())
+        : cols(cfg.cols), rows(cfg.rows), cells((uint32_t)cfg.cols * cfg.rows), capacity(cells + 1),
+          words((cells + 63) / 64), opts(options), headX(count), headY(count), dir(count), length(count),
+          bodyStart(count), growNext(count), food(count), score(count), ticks(count), idle(count),
+          finished(count), body(count * capacity), occ(count * words), rngs(count) {
+        for (size_t k = 0; k < count; ++k) {
+            rngs[k].seed(cfg.seed, cfg.rngKind, k); // one stream per environment
+            reset(k);
+        }
+    }
+
+    size_t size() const { return headX.size(); }
+    int width() const { return cols; }
+    int height() const { return rows; }
+
+    // restart environment k
+    void reset(size_t k) {
+        uint64_t* bits = &occ[k * words];
+        for (uint32_t w = 0; w < words; ++w) bits[w] = 0;
+        Vec2i start(cols / 2, rows / 2);
+        headX[k] = start.x;
+        headY[k] = start.y;
+        dir[k] = 3; // right
+        length[k] = 0;
+        bodyStart[k] = 0;
+        growNext[k] = 0;
+        score[k] = 0;
+        ticks[k] = 0;
+        idle[k] = 0;
+        finished[k] = 0;
+        uint32_t* ring = &body[k * capacity];
+        for (int i = 0; i < 5; ++i) {
+            int x = start.x - i;
+            if (x < 0) break;
+            uint32_t c = (uint32_t)start.y * cols + x;
+            ring[length[k]++] = c;
+            setBit(bits, c);
+        }
+        placeFood(k);
+    }
+
+    // apply actions[k] to every environment and write each one's outcome to
+    // results[k]; spread across the pool when one is given
+    void step(const Action* actions, StepResult* results, ThreadPool* pool = nullptr) {
+        if (!pool) {
+            stepRange(actions, results, 0, size());
+            return;
+        }
+        pool->parallelFor(size(), [&](size_t begin, size_t end) { stepRange(actions, results, begin, end); });
+    }
+
+    // per-environment state
+    Vec2i head(size_t k) const { return {headX[k], headY[k]}; }
+    Vec2i direction(size_t k) const { return dirs()[dir[k]]; }
+    Vec2i foodCell(size_t k) const { return {(int)(food[k] % cols), (int)(food[k] / cols)}; }
+    uint32_t snakeLength(size_t k) const { return length[k]; }
+    int scoreOf(size_t k) const { return score[k]; }
+    uint64_t tickOf(size_t k) const { return ticks[k]; }
+    bool done(size_t k) const { return finished[k] != 0; }
+    bool tailMovesNext(size_t k) const { return !growNext[k]; }
+    Vec2i tail(size_t k) const {
+        uint32_t c = body[k * capacity + slot(bodyStart[k], length[k] - 1)];
+        return {(int)(c % cols), (int)(c / cols)};
+    }
+    bool occupied(size_t k, Vec2i p) const {
+        if (p.x < 0 || p.x >= cols || p.y < 0 || p.y >= rows) return false;
+        return testBit(&occ[k * words], (uint32_t)p.y * cols + p.x);
+    }
+    // one occupancy bitset per environment, bit y*cols+x, wordsPerEnv() words each
+    const uint64_t* occupancy(size_t k) const { return &occ[k * words]; }
+    uint32_t wordsPerEnv() const { return words; }
+
+private:
+    static const Vec2i* dirs() {
+        // matches the Action order Up, Down, Left, Right
+        static const Vec2i table[4] = {{0, -1}, {0, 1}, {-1, 0}, {1, 0}};
+        return table;
+    }
+
+    static void setBit(uint64_t* bits, uint32_t c) { bits[c >> 6] |= uint64_t(1) << (c & 63); }
+    static void clearBit(uint64_t* bits, uint32_t c) { bits[c >> 6] &= ~(uint64_t(1) << (c & 63)); }
+    static bool testBit(const uint64_t* bits, uint32_t c) { return (bits[c >> 6] >> (c & 63)) & 1; }
+
+    uint32_t slot(uint32_t start, uint32_t i) const {
+        uint32_t j = start + i;
+        return j >= capacity ? j - capacity : j;
+    }
+
+    void stepRange(const Action* actions, StepResult* results, size_t begin, size_t end) {
+        for (size_t k = begin; k < end; ++k) results[k] = stepOne(k, actions[k]);
+    }
+
+    StepResult stepOne(size_t k, Action a) {
+        if (finished[k]) {
+            if (!opts.autoReset) return StepResult::Ended;
+            reset(k);
+        }
+        // prevent reversing
+        if (a != Action::None) {
+            uint8_t d = (uint8_t)a - 1;
+            if (length[k] <= 1 || (d ^ 1) != dir[k]) dir[k] = d; // Up^1 == Down, Left^1 == Right
+        }
+        ++ticks[k];
+        ++idle[k];
+        Vec2i d = dirs()[dir[k]];
+        int x = headX[k] + d.x;
+        int y = headY[k] + d.y;
+        headX[k] = x;
+        headY[k] = y;
+
+        // boundary collision
+        if (x < 0 || x >= cols || y < 0 || y >= rows) {
+            finished[k] = 1;
+            return StepResult::HitWall;
+        }
+
+        uint64_t* bits = &occ[k * words];
+        uint32_t* ring = &body[k * capacity];
+        uint32_t c = (uint32_t)y * cols + x;
+        // the tail leaves the board before the head's cell is checked, so the
+        // head may follow it (Snake::move() adds the head first, same outcome)
+        if (!growNext[k]) {
+            --length[k];
+            clearBit(bits, ring[slot(bodyStart[k], length[k])]);
+        }
+        growNext[k] = 0;
+        // self collision
+        if (testBit(bits, c)) {
+            finished[k] = 1;
+            return StepResult::HitSelf;
+        }
+        bodyStart[k] = bodyStart[k] == 0 ? capacity - 1 : bodyStart[k] - 1;
+        ring[bodyStart[k]] = c;
+        ++length[k];
+        setBit(bits, c);
+
+        if (c != food[k]) {
+            if (opts.starveTicks && idle[k] >= opts.starveTicks) {
+                finished[k] = 1;
+                return StepResult::Starved;
+            }
+            return StepResult::Moved;
+        }
+        growNext[k] = 1;
+        score[k] += 10;
+        idle[k] = 0;
+        if (!placeFood(k)) {
+            finished[k] = 1;
+            return StepResult::Won;
+        }
+        return StepResult::Ate;
+    }
+
+    // a uniformly drawn free cell, as GameState::placeFood(): one draw of n,
+    // then the n-th clear bit found by counting whole words (cells are in
+    // bitset order here, so the same n can land elsewhere than in GameState)
+    bool placeFood(size_t k) {
+        if (length[k] >= cells) return false;
+        const uint64_t* bits = &occ[k * words];
+        uint32_t n = (uint32_t)rngs[k].nextInt(0, (int)(cells - length[k]) - 1);
+        for (uint32_t w = 0; w < words; ++w) {
+            uint64_t freeBits = ~bits[w];
+            if (w == words - 1 && (cells & 63)) freeBits &= (uint64_t(1) << (cells & 63)) - 1;
+            const uint32_t free = (uint32_t)popcount64(freeBits);
+            if (n < free) {
+                food[k] = w * 64 + (uint32_t)selectBit64(freeBits, (int)n);
+                return true;
+            }
+            n -= free;
+        }
+        return false;
+    }
+
+    int cols;
+    int rows;
+    uint32_t cells;
+    uint32_t capacity; // ring slots per environment
+    uint32_t words;    // bitset words per environment
+    BatchEnvOptions opts;
+
+    std::vector<int32_t> headX;
+    std::vector<int32_t> headY;
+    std::vector<uint8_t> dir; // index into dirs()
+    std::vector<uint32_t> length;
+    std::vector<uint32_t> bodyStart; // ring slot of the head
+    std::vector<uint8_t> growNext;
+    std::vector<uint32_t> food; // cell index
+    std::vector<int32_t> score;
+    std::vector<uint64_t> ticks;
+    std::vector<uint32_t> idle; // ticks since the last meal
+    std::vector<uint8_t> finished;
+    std::vector<uint32_t> body; // size() rings of capacity cells
+    std::vector<uint64_t> occ;  // size() bitsets of words words
+    std::vector<RNG> rngs;
+};
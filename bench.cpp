@@ -0,0 +1,287 @@
+// bench.cpp
+// Tick and frame benchmark: runs scripted scenarios and reports latency
+// percentiles for each part of the update (move, collision, food placement,
+// the whole GameState::step), for a snapshot save + load round trip, for an
+// agent's observation encoding and for the render section: culled batches,
+// the incremental board canvas and the shader-drawn board.
+// Run: ./SnakeBench [--ticks N] [--scenario NAME] [--no-render]
+
+#include <SFML/Graphics.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "game_state.h"
+#include "hamiltonian.h"
+#include "headless.h"
+#include "observation.h"
+#include "render.h"
+#include "snapshot.h"
+
+using BenchClock = std::chrono::steady_clock;
+
+struct Scenario {
+    const char* name;
+    int cols;
+    int rows;
+    float fill; // fraction of the board covered by the snake at the start (0 = default short snake)
+};
+
+static const Scenario scenarios[] = {
+    {"short", 32, 24, 0.f},
+    {"fill50", 64, 64, 0.5f},
+    {"fill90", 64, 64, 0.9f},
+    {"large", 512, 512, 0.5f},
+    {"full", 64, 64, 0.999f},
+    {"huge", 2048, 2048, 0.25f},
+};
+
+// Single ops are too fast for the clock, so each sample times this many of
+// them and records the mean.
+static const int opsPerSample = 32;
+
+struct Samples {
+    std::vector<double> ns;
+
+    void add(BenchClock::duration d, int ops) { ns.push_back(std::chrono::duration<double, std::nano>(d).count() / ops); }
+
+    void report(const char* scenario, const char* op) {
+        if (ns.empty()) return;
+        std::sort(ns.begin(), ns.end());
+        auto pct = [&](double p) { return ns[std::min(ns.size() - 1, (size_t)(p * (ns.size() - 1) + 0.5))]; };
+        std::printf("%-8s %-10s %8zu %10.1f %10.1f %10.1f %10.1f\n", scenario, op, ns.size(), pct(0.5), pct(0.9),
+                    pct(0.99), ns.back());
+    }
+};
+
+// Game plus the scripted driver for one scenario. Filled scenarios lay the
+// snake along the cycle and keep following it, so they never die before the
+// board fills up; then the start state is restored.
+class ScenarioRun {
+public:
+    explicit ScenarioRun(const Scenario& sc) : sc(sc), game(makeConfig(sc)) {
+        cycle.prepare(sc.cols, sc.rows);
+        restart();
+    }
+
+    GameState& state() { return game; }
+
+    void restart() {
+        game.cfg = makeConfig(sc);
+        game.reset();
+        if (sc.fill <= 0.f) return;
+        size_t len = std::max<size_t>(2, (size_t)(sc.fill * cycle.size()));
+        std::vector<Vec2i> cells(len);
+        for (size_t i = 0; i < len; ++i) cells[i] = cycle.at(len - 1 - i); // head at cycle position len - 1
+        game.snake.assign(cells.data(), cells.size(), cells[0] - cells[1]);
+        game.placeFood();
+    }
+
+    // the greedy player for the short scenario, otherwise the direction that
+    // keeps the snake on the cycle
+    Action nextAction() const {
+        if (sc.fill <= 0.f) return greedyAction(game);
+        Vec2i h = game.snake.head();
+        return actionFor(cycle.after(h) - h);
+    }
+
+private:
+    static GameConfig makeConfig(const Scenario& sc) {
+        GameConfig cfg;
+        cfg.cols = sc.cols;
+        cfg.rows = sc.rows;
+        cfg.seed = 1;
+        return cfg;
+    }
+
+    Scenario sc;
+    GameState game;
+    HamiltonianCycle cycle;
+};
+
+static void runScenario(const Scenario& sc, int ticks, bool render) {
+    ScenarioRun run(sc);
+    GameState& game = run.state();
+    Samples step, move, collide, food, snapshot, observe, frame, incremental, shaded;
+
+    // whole logic tick
+    for (int n = 0; n < ticks; n += opsPerSample) {
+        auto t0 = BenchClock::now();
+        for (int i = 0; i < opsPerSample; ++i) {
+            game.step(run.nextAction());
+            if (game.gameOver) run.restart();
+        }
+        step.add(BenchClock::now() - t0, opsPerSample);
+    }
+
+    // the parts of a tick on their own. Moves include steering by the scripted
+    // player; growth stays off, so the scenario keeps its length.
+    run.restart();
+    volatile bool sink = false;
+    for (int n = 0; n < ticks; n += opsPerSample) {
+        bool hit = false;
+        int ops = 0;
+        auto t0 = BenchClock::now();
+        for (; ops < opsPerSample && !hit; ++ops) {
+            game.steer(run.nextAction());
+            game.snake.move();
+            Vec2i h = game.snake.head();
+            hit = h.x < 0 || h.x >= game.cfg.cols || h.y < 0 || h.y >= game.cfg.rows || game.snake.occupancy().count(h) > 1;
+        }
+        move.add(BenchClock::now() - t0, ops);
+        if (hit) {
+            run.restart();
+            continue;
+        }
+        auto t1 = BenchClock::now();
+        for (int i = 0; i < opsPerSample; ++i) {
+            Vec2i h = game.snake.head();
+            sink = h.x < 0 || h.x >= game.cfg.cols || h.y < 0 || h.y >= game.cfg.rows || game.snake.collidesWithSelf();
+        }
+        collide.add(BenchClock::now() - t1, opsPerSample);
+    }
+    (void)sink;
+    for (int n = 0; n < ticks; n += opsPerSample) {
+        auto t0 = BenchClock::now();
+        for (int i = 0; i < opsPerSample; ++i) game.placeFood();
+        food.add(BenchClock::now() - t0, opsPerSample);
+    }
+    // what a tree search does per node: copy out, then roll back. A round
+    // trip costs the snake's length, so long snakes get fewer of them.
+    GameSnapshot snap;
+    const int snapOps = (int)std::min<size_t>((size_t)ticks, std::max<size_t>(opsPerSample, 50000000 / (game.snake.body.size() + 1)));
+    for (int n = 0; n < snapOps; n += opsPerSample) {
+        auto t0 = BenchClock::now();
+        for (int i = 0; i < opsPerSample; ++i) {
+            saveSnapshot(game, snap);
+            loadSnapshot(game, snap);
+        }
+        snapshot.add(BenchClock::now() - t0, opsPerSample);
+    }
+    // an agent's observation of the state; costs the board size, so the
+    // largest boards get fewer of them and the huge one none
+    if ((size_t)sc.cols * sc.rows <= (size_t(1) << 20)) {
+        obs::Encoder encoder(sc.cols, sc.rows);
+        std::vector<float> out(encoder.size());
+        const int observeOps = (int)std::min<size_t>((size_t)ticks, std::max<size_t>(opsPerSample, 200000000 / encoder.size()));
+        for (int n = 0; n < observeOps; n += opsPerSample) {
+            auto t0 = BenchClock::now();
+            for (int i = 0; i < opsPerSample; ++i) encoder.encode(game, out.data());
+            observe.add(BenchClock::now() - t0, opsPerSample);
+        }
+    }
+
+    if (render) {
+        const GameConfig& cfg = game.cfg;
+        // a window-sized target and camera, as in main(), so frame cost
+        // shouldn't grow with the world
+        const sf::Vector2u size((unsigned)std::min(cfg.cols * cfg.cellSize, 1280), (unsigned)std::min(cfg.rows * cfg.cellSize, 960));
+        sf::RenderTexture target;
+        if (!target.resize(size)) {
+            std::printf("%-8s render     skipped (no render texture)\n", sc.name);
+        } else {
+            GridBackground background;
+            QuadBatch entities;
+            sf::View camera(sf::FloatRect({0.f, 0.f}, sf::Vector2f(size)));
+            int frames = std::max(1, std::min(ticks / 10, 2000));
+            run.restart();
+            for (int n = 0; n < frames; ++n) {
+                game.step(run.nextAction());
+                if (game.gameOver) run.restart();
+                // the same work as the render section in main() after a tick
+                auto t0 = BenchClock::now();
+                target.clear(palette::clear);
+                camera.setCenter(followCenter(game, 1.f, camera.getSize()));
+                target.setView(camera);
+                background.update(game.cfg);
+                background.draw(target);
+                buildVisibleEntities(entities, game, visibleCells(camera, cfg.cellSize, cfg.cols, cfg.rows));
+                entities.draw(target);
+                target.display();
+                frame.add(BenchClock::now() - t0, 1);
+            }
+
+            // the incremental path: the board texture, patched per tick
+            BoardCanvas canvas;
+            if (canvas.prepare(cfg)) {
+                run.restart();
+                canvas.invalidate();
+                for (int n = 0; n < frames; ++n) {
+                    game.step(run.nextAction());
+                    canvas.note(game);
+                    if (game.gameOver) run.restart();
+                    auto t0 = BenchClock::now();
+                    target.clear(palette::clear);
+                    camera.setCenter(followCenter(game, 1.f, camera.getSize()));
+                    target.setView(camera);
+                    canvas.sync(game);
+                    canvas.draw(target);
+                    buildMovingEntities(entities, game);
+                    entities.draw(target);
+                    target.display();
+                    incremental.add(BenchClock::now() - t0, 1);
+                }
+            }
+
+            // the shader path: one quad, two texel uploads per tick
+            ShaderBoard shaderBoard;
+            if (shaderBoard.prepare(cfg)) {
+                run.restart();
+                shaderBoard.invalidate();
+                for (int n = 0; n < frames; ++n) {
+                    game.step(run.nextAction());
+                    shaderBoard.note(game);
+                    if (game.gameOver) run.restart();
+                    auto t0 = BenchClock::now();
+                    target.clear(palette::clear);
+                    camera.setCenter(followCenter(game, 1.f, camera.getSize()));
+                    target.setView(camera);
+                    shaderBoard.sync(game);
+                    shaderBoard.draw(target);
+                    buildMovingEntities(entities, game);
+                    entities.draw(target);
+                    target.display();
+                    shaded.add(BenchClock::now() - t0, 1);
+                }
+            }
+        }
+    }
+
+    step.report(sc.name, "step");
+    move.report(sc.name, "move");
+    collide.report(sc.name, "collide");
+    food.report(sc.name, "placeFood");
+    snapshot.report(sc.name, "snapshot");
+    observe.report(sc.name, "observe");
+    frame.report(sc.name, "render");
+    incremental.report(sc.name, "canvas");
+    shaded.report(sc.name, "shader");
+}
+
+int main(int argc, char** argv) {
+    int ticks = 200000;
+    bool render = true;
+    const char* only = nullptr;
+    for (int i = 1; i < argc; ++i) {
+        if (!std::strcmp(argv[i], "--ticks") && i + 1 < argc) ticks = std::max(opsPerSample, std::atoi(argv[++i]));
+        else if (!std::strcmp(argv[i], "--scenario") && i + 1 < argc) only = argv[++i];
+        else if (!std::strcmp(argv[i], "--no-render")) render = false;
+        else {
+            std::printf("usage: %s [--ticks N] [--scenario short|fill50|fill90|large|full|huge] [--no-render]\n", argv[0]);
+            return std::strcmp(argv[i], "--help") ? 1 : 0;
+        }
+    }
+
+    std::printf("latency per op in ns (update samples average %d ops; render is CPU-side submission per frame)\n",
+                opsPerSample);
+    std::printf("%-8s %-10s %8s %10s %10s %10s %10s\n", "scenario", "op", "samples", "p50", "p90", "p99", "max");
+    for (const Scenario& sc : scenarios) {
+        if (only && std::strcmp(only, sc.name)) continue;
+        runScenario(sc, ticks, render);
+    }
+    return 0;
+}
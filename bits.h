@@ -0,0 +1,44 @@
+// bits.h
+// Bit counting on 64-bit words for the occupancy bitsets: the GCC / Clang
+// builtins, MSVC's intrinsics, or a plain loop elsewhere.
+
+#pragma once
+
+#include <cstdint>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+// number of set bits
+inline int popcount64(uint64_t x) {
+#if defined(__GNUC__)
+    return __builtin_popcountll(x);
+#elif defined(_MSC_VER) && defined(_M_X64)
+    return (int)__popcnt64(x);
+#else
+    int n = 0;
+    for (; x; x &= x - 1) ++n;
+    return n;
+#endif
+}
+
+// index of the lowest set bit; x must not be 0
+inline int ctz64(uint64_t x) {
+#if defined(__GNUC__)
+    return __builtin_ctzll(x);
+#elif defined(_MSC_VER) && defined(_M_X64)
+    unsigned long i;
+    _BitScanForward64(&i, x);
+    return (int)i;
+#else
+    int i = 0;
+    for (; !(x & 1); x >>= 1) ++i;
+    return i;
+#endif
+}
+
+// index of the n-th set bit (n < popcount64(x))
+inline int selectBit64(uint64_t x, int n) {
+    for (; n > 0; --n) x &= x - 1;
+    return ctz64(x);
+}
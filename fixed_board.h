@@ -0,0 +1,205 @@
+// fixed_board.h
+// GameState with the board size fixed at compile time, for headless runs on
+// the common sizes. Dimensions are constexpr and all storage is std::array
+// inside the object, so bounds checks and cell indexing fold to constants
+// (shifts and masks when the sides are powers of two) and the step has no
+// vector indirection left for the compiler to work around. Rules, RNG use
+// and the free-cell order (64x64 chunks, row-major inside each, as in
+// OccupancyGrid) are the same as GameState's, so a seed plays out identically
+// on either; sizes without an instantiation keep using GameState.
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+#include "bits.h"
+#include "game_state.h"
+
+// Segment counts plus the occupied bitset and per-chunk free counts of
+// OccupancyGrid, flat and fully allocated. Cells are y * Cols + x.
+template <int Cols, int Rows>
+class FixedBoard {
+public:
+    static_assert(Cols >= 8 && Rows >= 2 && Cols <= 4096 && Rows <= 4096, "board side out of range");
+    static constexpr uint32_t cells = (uint32_t)Cols * Rows;
+    static constexpr bool powerOfTwo = (Cols & (Cols - 1)) == 0 && (Rows & (Rows - 1)) == 0;
+
+    static constexpr bool inBounds(Vec2i p) {
+        if constexpr (powerOfTwo) return (((unsigned)p.x & ~(unsigned)(Cols - 1)) | ((unsigned)p.y & ~(unsigned)(Rows - 1))) == 0;
+        else return (unsigned)p.x < (unsigned)Cols && (unsigned)p.y < (unsigned)Rows;
+    }
+    static constexpr uint32_t index(Vec2i p) { return (uint32_t)p.y * Cols + (uint32_t)p.x; }
+    static constexpr Vec2i at(uint32_t c) { return {(int)(c % Cols), (int)(c / Cols)}; }
+
+    void clear() {
+        counts.fill(0);
+        bits.fill(0);
+        for (int cy = 0; cy < chunksY; ++cy)
+            for (int cx = 0; cx < chunksX; ++cx) chunkFree[(size_t)cy * chunksX + cx] = (uint16_t)(chunkW(cx) * chunkH(cy));
+        freeTotal = cells;
+    }
+
+    bool occupied(Vec2i p) const { return inBounds(p) && counts[index(p)] > 0; }
+    bool occupied(uint32_t c) const { return counts[c] > 0; }
+
+    void add(uint32_t c) {
+        if (counts[c]++ != 0) return;
+        bits[word(c)] |= uint64_t(1) << ((c % Cols) & 63);
+        --chunkFree[chunkOf(c)];
+        --freeTotal;
+    }
+
+    void remove(uint32_t c) {
+        if (--counts[c] != 0) return;
+        bits[word(c)] &= ~(uint64_t(1) << ((c % Cols) & 63));
+        ++chunkFree[chunkOf(c)];
+        ++freeTotal;
+    }
+
+    uint32_t freeCount() const { return freeTotal; }
+
+    // the n-th free cell (n < freeCount()), in OccupancyGrid::freeCell()'s order
+    uint32_t freeCell(uint32_t n) const {
+        size_t c = 0;
+        for (; n >= chunkFree[c]; ++c) n -= chunkFree[c];
+        const int cx = (int)(c % chunksX), y0 = (int)(c / chunksX) * chunkSize;
+        const uint64_t pad = chunkW(cx) == chunkSize ? 0 : ~uint64_t(0) << (chunkW(cx) & 63); // columns past the board
+        int row = 0;
+        uint64_t freeBits = ~(bits[(size_t)y0 * chunksX + cx] | pad);
+        for (uint32_t k; n >= (k = (uint32_t)popcount64(freeBits));
+             freeBits = ~(bits[(size_t)(y0 + ++row) * chunksX + cx] | pad))
+            n -= k;
+        return index(Vec2i(cx * chunkSize + selectBit64(freeBits, (int)n), y0 + row));
+    }
+
+private:
+    static constexpr int chunkSize = OccupancyGrid::chunkSize;
+    static constexpr int chunksX = (Cols + chunkSize - 1) / chunkSize;
+    static constexpr int chunksY = (Rows + chunkSize - 1) / chunkSize;
+
+    static constexpr int chunkW(int cx) { return std::min(chunkSize, Cols - cx * chunkSize); }
+    static constexpr int chunkH(int cy) { return std::min(chunkSize, Rows - cy * chunkSize); }
+    // one word per board row per chunk column
+    static constexpr size_t word(uint32_t c) { return (size_t)(c / Cols) * chunksX + (c % Cols) / chunkSize; }
+    static constexpr size_t chunkOf(uint32_t c) { return (size_t)(c / Cols / chunkSize) * chunksX + (c % Cols) / chunkSize; }
+
+    std::array<uint8_t, cells> counts;
+    std::array<uint64_t, (size_t)Rows * chunksX> bits;
+    std::array<uint16_t, (size_t)chunksX * chunksY> chunkFree;
+    uint32_t freeTotal = 0;
+};
+
+// One game on a Cols x Rows board: GameState's rules and fields, with the
+// body as a ring of cell indices. Large instantiations are a few hundred KB,
+// so keep them off the stack.
+template <int Cols, int Rows>
+class FixedGameState {
+public:
+    static constexpr int cols = Cols;
+    static constexpr int rows = Rows;
+    using Board = FixedBoard<Cols, Rows>;
+
+    GameConfig cfg; // cols and rows forced to the template's; moveInterval shrinks as the score grows
+    RNG rng;
+    Vec2i dir{1, 0};
+    Vec2i food;
+    bool growNext = false;
+    int score = 0;
+    bool gameOver = false;
+    bool won = false;
+    uint64_t tick = 0;
+
+    explicit FixedGameState(const GameConfig& config) : cfg(config), rng(config.seed, config.rngKind) {
+        cfg.cols = Cols;
+        cfg.rows = Rows;
+        reset();
+    }
+
+    // as GameState::reset(): the RNG stream carries on into the next round
+    void reset() {
+        board.clear();
+        start = 0;
+        count = 0;
+        headPos = Vec2i(Cols / 2, Rows / 2);
+        for (int i = 0; i < 5; ++i) {
+            const uint32_t c = Board::index(Vec2i(headPos.x - i, headPos.y));
+            ring[count++] = c;
+            board.add(c);
+        }
+        dir = {1, 0};
+        growNext = false;
+        score = 0;
+        gameOver = false;
+        won = false;
+        tick = 0;
+        placeFood();
+    }
+
+    Vec2i head() const { return headPos; }
+    Vec2i tail() const { return Board::at(ring[slot(count - 1)]); }
+    uint32_t length() const { return count; }
+    bool occupied(Vec2i p) const { return board.occupied(p); }
+    const Board& occupancy() const { return board; }
+
+    StepResult step(Action a = Action::None) {
+        if (gameOver) return StepResult::Ended;
+        if (a != Action::None) {
+            const Vec2i d = directionOf(a);
+            if (count <= 1 || d != Vec2i(-dir.x, -dir.y)) dir = d;
+        }
+        ++tick;
+        headPos += dir;
+        if (!Board::inBounds(headPos)) {
+            gameOver = true;
+            return StepResult::HitWall;
+        }
+        // the tail (unless growing) is taken off the board before the head's
+        // cell is checked, so the head may move into the cell the tail left;
+        // Snake::move() adds the head first and counts it twice, same outcome
+        const uint32_t c = Board::index(headPos);
+        if (!growNext) board.remove(ring[slot(--count)]);
+        growNext = false;
+        if (board.occupied(c)) {
+            gameOver = true;
+            return StepResult::HitSelf;
+        }
+        start = start == 0 ? capacity - 1 : start - 1;
+        ring[start] = c;
+        ++count;
+        board.add(c);
+
+        if (c != foodCell) return StepResult::Moved;
+        growNext = true;
+        score += 10;
+        if (!placeFood()) {
+            gameOver = true;
+            won = true;
+            return StepResult::Won;
+        }
+        if (score % 50 == 0 && cfg.moveInterval > 0.04f) cfg.moveInterval *= 0.92f;
+        return StepResult::Ate;
+    }
+
+    bool placeFood() {
+        if (board.freeCount() == 0) return false;
+        foodCell = board.freeCell((uint32_t)rng.nextInt(0, (int)board.freeCount() - 1));
+        food = Board::at(foodCell);
+        return true;
+    }
+
+private:
+    static constexpr uint32_t capacity = Board::cells + 1;
+
+    uint32_t slot(uint32_t i) const {
+        const uint32_t j = start + i;
+        return j >= capacity ? j - capacity : j;
+    }
+
+    Board board;
+    std::array<uint32_t, capacity> ring; // body cells, head at start
+    uint32_t start = 0;
+    uint32_t count = 0;
+    Vec2i headPos;
+    uint32_t foodCell = 0;
+};
@@ -0,0 +1,54 @@
+// frame_arena.h
+// Bump allocator for scratch memory that only lives for one frame. The block
+// is allocated once; reset() at the top of the frame rewinds it, so
+// temporaries in the frame loop never reach the heap.
+
+#pragma once
+
+#include <cstdarg>
+#include <cstddef>
+#include <cstdio>
+#include <memory>
+
+class FrameArena {
+public:
+    explicit FrameArena(size_t capacity) : buffer(new unsigned char[capacity]), capacity(capacity) {}
+
+    void reset() { used = 0; }
+
+    // nullptr when the arena is exhausted; callers degrade instead of allocating
+    void* allocate(size_t bytes, size_t align = alignof(std::max_align_t)) {
+        size_t p = (used + align - 1) & ~(align - 1);
+        if (p + bytes > capacity) return nullptr;
+        used = p + bytes;
+        if (used > highWater) highWater = used;
+        return buffer.get() + p;
+    }
+
+    template <class T>
+    T* allocArray(size_t n) {
+        return static_cast<T*>(allocate(n * sizeof(T), alignof(T)));
+    }
+
+    // printf into arena memory; returns "" when it does not fit
+    const char* format(const char* fmt, ...) {
+        char* out = reinterpret_cast<char*>(buffer.get() + used);
+        size_t room = capacity - used;
+        va_list args;
+        va_start(args, fmt);
+        int n = std::vsnprintf(out, room, fmt, args);
+        va_end(args);
+        if (n < 0 || (size_t)n >= room) return "";
+        allocate((size_t)n + 1, 1);
+        return out;
+    }
+
+    size_t bytesUsed() const { return used; }
+    size_t peak() const { return highWater; }
+
+private:
+    std::unique_ptr<unsigned char[]> buffer;
+    size_t capacity;
+    size_t used = 0;
+    size_t highWater = 0;
+};
@@ -0,0 +1,449 @@
+// game_state.h
+// Snake game rules with no window, clock or event loop dependency, so the same
+// update step drives the SFML front end, headless runs and tools.
+
+#pragma once
+
+#include <SFML/System/Vector2.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "bits.h"
+#include "profiler.h"
+#include "rng.h"
+
+using Vec2i = sf::Vector2i;
+
+struct GameConfig {
+    int cellSize = 20;
+    int cols = 32; // grid width
+    int rows = 24; // grid height
+    float moveInterval = 0.12f; // seconds per move (smaller => faster)
+    uint64_t seed = 0; // food placement is fully determined by seed and rngKind
+    RngKind rngKind = RngKind::Pcg32;
+};
+
+// Number of snake segments on each cell, so occupancy queries are O(1) instead
+// of walking the body. Cells outside the board are never counted.
+// The board is split into 64x64-cell chunks whose storage (counters plus an
+// occupied bitset, one word per chunk row) is only allocated once the snake
+// first enters them, so huge worlds cost memory in proportion to where the
+// snake has been. Free cells are counted per chunk, and a Fenwick tree over
+// those counts finds the chunk holding the n-th free cell (in chunk order,
+// row-major inside a chunk) in log(chunks) steps, then a short scan of its
+// rows finds the cell. The
+// answer depends only on which cells are occupied, not on the order they were
+// filled, so a game rebuilt from a snapshot places its food exactly like the
+// original.
+class OccupancyGrid {
+public:
+    static constexpr int chunkShift = 6;
+    static constexpr int chunkSize = 1 << chunkShift; // cells per chunk side
+
+    OccupancyGrid() = default;
+    OccupancyGrid(int cols, int rows) { reset(cols, rows); }
+
+    // empty the board; allocated chunks are kept and reused. The pool is
+    // reserved for every chunk here (only pages the snake reaches are ever
+    // touched), so entering a new chunk mid-game never allocates
+    void reset(int newCols, int newRows) {
+        cols = newCols;
+        rows = newRows;
+        chunksX = (cols + chunkSize - 1) >> chunkShift;
+        chunksY = (rows + chunkSize - 1) >> chunkShift;
+        chunkSlot.assign((size_t)chunksX * chunksY, -1);
+        chunkFree.resize(chunkSlot.size());
+        for (int cy = 0; cy < chunksY; ++cy)
+            for (int cx = 0; cx < chunksX; ++cx) chunkFree[(size_t)cy * chunksX + cx] = (uint16_t)(chunkW(cx) * chunkH(cy));
+        buildTree();
+        pool.reserve(chunkSlot.size());
+        used = 0;
+        freeTotal = (size_t)cols * rows;
+    }
+
+    bool inBounds(const Vec2i& p) const { return p.x >= 0 && p.x < cols && p.y >= 0 && p.y < rows; }
+
+    int count(const Vec2i& p) const {
+        if (!inBounds(p)) return 0;
+        int slot = chunkSlot[chunkOf(p)];
+        return slot < 0 ? 0 : pool[slot].counts[local(p)];
+    }
+
+    void add(const Vec2i& p) {
+        if (!inBounds(p)) return;
+        size_t c = chunkOf(p);
+        Chunk& ch = chunk(c);
+        int i = local(p);
+        if (ch.counts[i]++ == 0) {
+            ch.bits[i >> chunkShift] |= uint64_t(1) << (i & (chunkSize - 1));
+            --chunkFree[c];
+            treeAdd(c, -1);
+            --freeTotal;
+        }
+    }
+
+    void remove(const Vec2i& p) {
+        if (!inBounds(p)) return;
+        size_t c = chunkOf(p);
+        Chunk& ch = pool[chunkSlot[c]];
+        int i = local(p);
+        if (--ch.counts[i] == 0) {
+            ch.bits[i >> chunkShift] &= ~(uint64_t(1) << (i & (chunkSize - 1)));
+            ++chunkFree[c];
+            treeAdd(c, 1);
+            ++freeTotal;
+        }
+    }
+
+    size_t freeCount() const { return freeTotal; }
+
+    // occupied bits of board row y inside chunk column cx (bit i is cell
+    // x = cx * chunkSize + i), 0 for chunks never touched
+    int chunkColumns() const { return chunksX; }
+    uint64_t rowBits(int y, int cx) const {
+        int slot = chunkSlot[(size_t)(y >> chunkShift) * chunksX + cx];
+        return slot < 0 ? 0 : pool[slot].bits[y & (chunkSize - 1)];
+    }
+
+    // the n-th free cell (n < freeCount())
+    Vec2i freeCell(size_t n) const {
+        const size_t c = findChunk(n);
+        const int cx = (int)(c % chunksX), cy = (int)(c / chunksX);
+        const Vec2i origin(cx << chunkShift, cy << chunkShift);
+        if (chunkSlot[c] < 0) {
+            // never touched: every cell is free
+            int w = chunkW(cx);
+            return origin + Vec2i((int)n % w, (int)n / w);
+        }
+        const Chunk& ch = pool[chunkSlot[c]];
+        const uint64_t pad = chunkW(cx) == chunkSize ? 0 : ~uint64_t(0) << chunkW(cx); // columns past the board
+        int row = 0;
+        uint64_t freeBits = ~(ch.bits[0] | pad);
+        for (size_t k; n >= (k = (size_t)popcount64(freeBits)); freeBits = ~(ch.bits[++row] | pad)) n -= k;
+        return origin + Vec2i(selectBit64(freeBits, (int)n), row);
+    }
+
+    // free cells before p in freeCell()'s order, for a free p: freeCell(freeRank(p)) == p
+    size_t freeRank(const Vec2i& p) const {
+        const size_t c = chunkOf(p);
+        size_t n = 0;
+        for (size_t i = c; i > 0; i -= i & (0 - i)) n += tree[i]; // chunks before c
+        const int cx = (int)(c % chunksX);
+        const int lx = p.x & (chunkSize - 1), ly = p.y & (chunkSize - 1);
+        if (chunkSlot[c] < 0) return n + (size_t)ly * chunkW(cx) + lx;
+        const Chunk& ch = pool[chunkSlot[c]];
+        const uint64_t pad = chunkW(cx) == chunkSize ? 0 : ~uint64_t(0) << chunkW(cx);
+        for (int row = 0; row < ly; ++row) n += (size_t)popcount64(~(ch.bits[row] | pad));
+        return n + (size_t)popcount64(~ch.bits[ly] & ((uint64_t(1) << lx) - 1));
+    }
+
+private:
+    struct Chunk {
+        uint8_t counts[chunkSize * chunkSize]; // only the head can ever share a cell, so 8 bits is plenty
+        uint64_t bits[chunkSize];              // one word per chunk row, bit x set when occupied
+    };
+
+    int chunkW(int cx) const { return std::min(chunkSize, cols - (cx << chunkShift)); }
+    int chunkH(int cy) const { return std::min(chunkSize, rows - (cy << chunkShift)); }
+    size_t chunkOf(const Vec2i& p) const { return (size_t)(p.y >> chunkShift) * chunksX + (p.x >> chunkShift); }
+    static int local(const Vec2i& p) { return ((p.y & (chunkSize - 1)) << chunkShift) | (p.x & (chunkSize - 1)); }
+
+    // Fenwick tree: tree[i] sums chunkFree over (i - lowbit(i), i]
+    void buildTree() {
+        tree.assign(chunkFree.size() + 1, 0);
+        for (size_t i = 1; i < tree.size(); ++i) {
+            tree[i] += chunkFree[i - 1];
+            const size_t parent = i + (i & (0 - i));
+            if (parent < tree.size()) tree[parent] += tree[i];
+        }
+        treeTop = 1;
+        while (treeTop * 2 < tree.size()) treeTop *= 2;
+    }
+
+    void treeAdd(size_t c, int delta) {
+        for (size_t i = c + 1; i < tree.size(); i += i & (0 - i)) tree[i] += (uint32_t)delta;
+    }
+
+    // the chunk holding the n-th free cell; n becomes the index inside it
+    size_t findChunk(size_t& n) const {
+        size_t pos = 0;
+        for (size_t step = treeTop; step > 0; step >>= 1) {
+            if (pos + step < tree.size() && tree[pos + step] <= n) {
+                pos += step;
+                n -= tree[pos];
+            }
+        }
+        return pos;
+    }
+
+    // storage for chunk c, taken from the pool on first use
+    Chunk& chunk(size_t c) {
+        if (chunkSlot[c] < 0) {
+            if (used == pool.size()) pool.emplace_back();
+            Chunk& ch = pool[used];
+            std::memset(&ch, 0, sizeof ch);
+            chunkSlot[c] = (int)used++;
+        }
+        return pool[chunkSlot[c]];
+    }
+
+    int cols = 0;
+    int rows = 0;
+    int chunksX = 0;
+    int chunksY = 0;
+    std::vector<int> chunkSlot;      // pool index of each chunk, -1 while untouched
+    std::vector<uint16_t> chunkFree; // free cells in each chunk
+    std::vector<uint32_t> tree;      // Fenwick tree over chunkFree, 1-based
+    size_t treeTop = 1;              // highest power of two below tree.size()
+    std::vector<Chunk> pool;         // the first `used` are live
+    size_t used = 0;
+    size_t freeTotal = 0;
+};
+
+// Ring buffer holding the snake's segments, front is head. Storage is one
+// contiguous array reserved up front, so moving never allocates; it only
+// doubles if the snake outgrows the reservation.
+class SnakeBody {
+public:
+    // make room for at least capacity segments and empty the body
+    void reserve(size_t capacity) {
+        if (capacity > cells.size()) cells.assign(capacity, Vec2i());
+        clear();
+    }
+
+    void clear() { start = 0; count = 0; }
+
+    size_t size() const { return count; }
+    size_t capacity() const { return cells.size(); }
+    bool empty() const { return count == 0; }
+
+    const Vec2i& front() const { return cells[start]; }
+    const Vec2i& back() const { return (*this)[count - 1]; }
+    const Vec2i& operator[](size_t i) const {
+        size_t j = start + i;
+        if (j >= cells.size()) j -= cells.size();
+        return cells[j];
+    }
+
+    void push_front(const Vec2i& p) {
+        if (count == cells.size()) grow();
+        start = start == 0 ? cells.size() - 1 : start - 1;
+        cells[start] = p;
+        ++count;
+    }
+    void push_back(const Vec2i& p) {
+        if (count == cells.size()) grow();
+        ++count;
+        cells[wrap(start + count - 1)] = p;
+    }
+    void pop_back() { --count; }
+
+private:
+    size_t wrap(size_t j) const { return j >= cells.size() ? j - cells.size() : j; }
+
+    // double the ring, unrolled so the head lands in slot 0
+    void grow() {
+        std::vector<Vec2i> bigger(std::max<size_t>(16, cells.size() * 2));
+        for (size_t i = 0; i < count; ++i) bigger[i] = (*this)[i];
+        cells.swap(bigger);
+        start = 0;
+    }
+
+    std::vector<Vec2i> cells;
+    size_t start = 0; // slot of the head
+    size_t count = 0;
+};
+
+class Snake {
+public:
+    SnakeBody body; // front is head
+    Vec2i dir{1, 0};
+    bool growNext = false;
+    Vec2i prevTail; // tail cell before the last move, for interpolated drawing
+
+    Snake(const GameConfig& cfg, Vec2i start, int initialLength = 4) { reset(cfg, start, initialLength); }
+
+    // put the snake back at its start position, reusing body and grid storage
+    void reset(const GameConfig& cfg, Vec2i start, int initialLength = 4) {
+        // a full board plus the new head that is pushed before the tail pops;
+        // huge worlds start smaller and grow the ring as the snake does
+        body.reserve(std::min<size_t>((size_t)cfg.cols * cfg.rows + 1, size_t(1) << 20));
+        grid.reset(cfg.cols, cfg.rows);
+        dir = {1, 0};
+        growNext = false;
+        for (int i = 0; i < initialLength; ++i) {
+            body.push_back({start.x - i, start.y});
+            grid.add(body.back());
+        }
+        prevTail = body.back();
+    }
+
+    // replace the body with cells[0..n) (head first) moving in direction d
+    void assign(const Vec2i* cells, size_t n, Vec2i d) {
+        size_t i = 0;
+        assign(n, d, [&] { return cells[i++]; });
+    }
+
+    // the same with the cells produced head first by next(); costs the old
+    // plus the new length, not the board size
+    template <class NextCell>
+    void assign(size_t n, Vec2i d, NextCell next) {
+        for (size_t i = 0; i < body.size(); ++i) grid.remove(body[i]);
+        body.clear();
+        for (size_t i = 0; i < n; ++i) {
+            body.push_back(next());
+            grid.add(body.back());
+        }
+        dir = d;
+        growNext = false;
+        prevTail = body.back();
+    }
+
+    Vec2i head() const { return body.front(); }
+
+    void setDirection(const Vec2i& d) {
+        // prevent reversing
+        if (body.size() > 1 && d == Vec2i(-dir.x, -dir.y)) return;
+        dir = d;
+    }
+
+    void move() {
+        Vec2i newHead = head() + dir;
+        body.push_front(newHead);
+        grid.add(newHead);
+        prevTail = body.back();
+        if (!growNext) {
+            grid.remove(body.back());
+            body.pop_back();
+        }
+        growNext = false;
+    }
+
+    void grow() { growNext = true; }
+
+    // the head shares its cell with another segment
+    bool collidesWithSelf() const { return grid.count(head()) > 1; }
+
+    bool occupies(const Vec2i &p) const { return grid.count(p) > 0; }
+
+    const OccupancyGrid& occupancy() const { return grid; }
+
+private:
+    OccupancyGrid grid;
+};
+
+enum class Action : uint8_t { None, Up, Down, Left, Right };
+
+inline Vec2i directionOf(Action a) {
+    switch (a) {
+        case Action::Up: return {0, -1};
+        case Action::Down: return {0, 1};
+        case Action::Left: return {-1, 0};
+        case Action::Right: return {1, 0};
+        default: return {0, 0};
+    }
+}
+
+// the Action that moves by the unit step d
+inline Action actionFor(Vec2i d) {
+    if (d.y < 0) return Action::Up;
+    if (d.y > 0) return Action::Down;
+    return d.x < 0 ? Action::Left : Action::Right;
+}
+
+enum class StepResult {
+    Moved,   // plain move
+    Ate,     // moved onto the food and grew
+    HitWall, // left the board, game over
+    HitSelf, // ran into its own body, game over
+    Won,     // ate the last free cell, game over
+    Ended,   // the game was already over, nothing happened
+    Starved, // batch environments only: episode cut off after too long without food
+    HitSnake // arenas only: ran into another snake's body or head, out of this life
+};
+
+// Complete game: snake, food, score and the speed-up of moveInterval.
+// step() is one logic tick; the caller decides when ticks happen.
+class GameState {
+public:
+    GameConfig cfg; // moveInterval shrinks as the score grows
+    Snake snake;
+    RNG rng;
+    Vec2i food;
+    int score = 0;
+    bool gameOver = false;
+    bool won = false;
+    uint64_t tick = 0;
+
+    explicit GameState(const GameConfig& config) : cfg(config), snake(config, startPos(), 5), rng(config.seed, config.rngKind) {
+        placeFood();
+    }
+
+    // start snake centered
+    Vec2i startPos() const { return {cfg.cols / 2, cfg.rows / 2}; }
+
+    // restart, reusing the snake's storage; the RNG stream carries on, so a new
+    // round gets new food positions
+    void reset() {
+        snake.reset(cfg, startPos(), 5);
+        score = 0;
+        gameOver = false;
+        won = false;
+        tick = 0;
+        placeFood();
+    }
+
+    void steer(Action a) {
+        if (a != Action::None) snake.setDirection(directionOf(a));
+    }
+
+    StepResult step(Action a = Action::None) {
+        if (gameOver) return StepResult::Ended;
+        {
+            SNAKE_ZONE("move");
+            steer(a);
+            ++tick;
+            snake.move();
+        }
+
+        const Vec2i h = snake.head();
+        {
+            SNAKE_ZONE("collision");
+            // boundary collision
+            if (h.x < 0 || h.x >= cfg.cols || h.y < 0 || h.y >= cfg.rows) {
+                gameOver = true;
+                return StepResult::HitWall;
+            }
+            // self collision
+            if (snake.collidesWithSelf()) {
+                gameOver = true;
+                return StepResult::HitSelf;
+            }
+        }
+
+        // food?
+        if (h != food) return StepResult::Moved;
+        SNAKE_ZONE("food");
+        snake.grow();
+        score += 10;
+        if (!placeFood()) {
+            // no free cell left: the snake filled the board
+            gameOver = true;
+            won = true;
+            return StepResult::Won;
+        }
+        // optional speed up slightly every X points
+        if (score % 50 == 0 && cfg.moveInterval > 0.04f) cfg.moveInterval *= 0.92f;
+        return StepResult::Ate;
+    }
+
+    // pick a random free cell; returns false when the snake fills the board
+    bool placeFood() {
+        const OccupancyGrid& grid = snake.occupancy();
+        if (grid.freeCount() == 0) return false;
+        food = grid.freeCell((size_t)rng.nextInt(0, (int)grid.freeCount() - 1));
+        return true;
+    }
+};
@@ -0,0 +1,201 @@
+// hamiltonian.h
+// Hamiltonian cycle over the board, a closed path through every cell, and a
+// player that follows it. A snake that never leaves the cycle can't trap
+// itself, so it eventually fills the whole board: the worst case for
+// collision checks, food placement and rendering.
+// Cycles are built once per board size and cached on disk.
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "game_state.h"
+
+class HamiltonianCycle {
+public:
+    // build (or load from cacheDir) the cycle for a cols x rows board; boards
+    // with an odd number of cells have none. An empty cacheDir skips the cache.
+    bool prepare(int newCols, int newRows, const std::string& cacheDir = "snake_cache") {
+        if (newCols == cols && newRows == rows && !order.empty()) return true;
+        cols = newCols;
+        rows = newRows;
+        order.clear();
+        index.clear();
+        if (cols < 2 || rows < 2 || (cols % 2 && rows % 2)) return false;
+        std::string path = cacheDir.empty() ? std::string()
+                                            : cacheDir + "/cycle_" + std::to_string(cols) + "x" + std::to_string(rows) + ".bin";
+        if (path.empty() || !load(path)) {
+            build();
+            if (!path.empty()) {
+                std::error_code ec;
+                std::filesystem::create_directories(cacheDir, ec);
+                save(path); // a read-only directory just means no cache
+            }
+        }
+        index.assign(order.size(), 0);
+        for (uint32_t i = 0; i < order.size(); ++i) index[order[i]] = i;
+        return true;
+    }
+
+    bool valid() const { return !order.empty(); }
+    size_t size() const { return order.size(); }
+
+    // position of p along the cycle, and the cell at position i
+    uint32_t indexOf(Vec2i p) const { return index[(size_t)p.y * cols + p.x]; }
+    Vec2i at(size_t i) const { return {(int)(order[i] % cols), (int)(order[i] / cols)}; }
+    Vec2i after(Vec2i p) const { return at(indexOf(p) + 1 == order.size() ? 0 : indexOf(p) + 1); }
+
+    // steps along the cycle from a to b
+    uint32_t distance(Vec2i a, Vec2i b) const {
+        uint32_t ia = indexOf(a), ib = indexOf(b);
+        return ib >= ia ? ib - ia : (uint32_t)order.size() - ia + ib;
+    }
+
+private:
+    // with an even number of rows: along row 0, serpentine through columns
+    // 1.. of the remaining rows, back up column 0. Otherwise the same on the
+    // transposed board.
+    void build() {
+        const bool transpose = rows % 2 != 0;
+        const int w = transpose ? rows : cols;
+        const int h = transpose ? cols : rows;
+        order.reserve((size_t)w * h);
+        auto push = [&](int x, int y) {
+            if (transpose) std::swap(x, y);
+            order.push_back((uint32_t)(y * cols + x));
+        };
+        for (int x = 0; x < w; ++x) push(x, 0);
+        for (int y = 1; y < h; ++y) {
+            if (y % 2 == 1)
+                for (int x = w - 1; x >= 1; --x) push(x, y);
+            else
+                for (int x = 1; x < w; ++x) push(x, y);
+        }
+        for (int y = h - 1; y >= 1; --y) push(0, y);
+    }
+
+    // file: "SNKH", cols, rows, then cols*rows cell indices, all uint32
+    bool load(const std::string& path) {
+        FILE* f = std::fopen(path.c_str(), "rb");
+        if (!f) return false;
+        uint32_t header[3];
+        size_t n = (size_t)cols * rows;
+        bool ok = std::fread(header, sizeof header, 1, f) == 1 && header[0] == magic && header[1] == (uint32_t)cols &&
+                  header[2] == (uint32_t)rows;
+        if (ok) {
+            order.resize(n);
+            ok = std::fread(order.data(), sizeof(uint32_t), n, f) == n;
+        }
+        std::fclose(f);
+        // reject anything that isn't a permutation of the cells, or that has a
+        // step (last to first included) between cells that don't share a side
+        std::vector<uint8_t> hit(ok ? n : 0);
+        for (size_t i = 0; ok && i < n; ++i) {
+            ok = order[i] < n && !hit[order[i]];
+            if (ok) hit[order[i]] = 1;
+        }
+        for (size_t i = 0; ok && i < n; ++i) {
+            const Vec2i a = at(i), b = at(i + 1 == n ? 0 : i + 1);
+            ok = std::abs(a.x - b.x) + std::abs(a.y - b.y) == 1;
+        }
+        if (!ok) order.clear();
+        return ok;
+    }
+
+    void save(const std::string& path) const {
+        FILE* f = std::fopen(path.c_str(), "wb");
+        if (!f) return;
+        const uint32_t header[3] = {magic, (uint32_t)cols, (uint32_t)rows};
+        std::fwrite(header, sizeof header, 1, f);
+        std::fwrite(order.data(), sizeof(uint32_t), order.size(), f);
+        std::fclose(f);
+    }
+
+    static constexpr uint32_t magic = 0x484b4e53; // "SNKH" little-endian
+
+    int cols = 0;
+    int rows = 0;
+    std::vector<uint32_t> order; // cell index at each cycle position
+    std::vector<uint32_t> index; // cycle position of each cell
+};
+
+// Follows the cycle, cutting ahead toward the food while the snake is short.
+// The body always lies in cycle order from tail to head; a shortcut may only
+// land further ahead of the head, not past the food and not close to the
+// tail, so that stays true and the tail is never cut off.
+class CyclePlayer {
+public:
+    // fraction of the board the snake may cover and still take shortcuts
+    static constexpr float shortcutFill = 0.5f;
+    // free cells a shortcut leaves in front of the tail
+    static constexpr uint32_t shortcutGap = 4;
+
+    bool prepare(int cols, int rows, const std::string& cacheDir = "snake_cache") {
+        aligned = false;
+        return cycle.prepare(cols, rows, cacheDir);
+    }
+
+    // a restarted snake may not lie along the cycle
+    void clear() { aligned = false; }
+
+    const HamiltonianCycle& path() const { return cycle; }
+
+    // None when there is no cycle, or when the snake, not yet lying along the
+    // cycle, can't take its next cell; the caller steers that tick itself
+    Action decide(const GameState& g) {
+        if (!cycle.valid()) return Action::None;
+        const Snake& snake = g.snake;
+        const Vec2i head = snake.head();
+        const Vec2i tail = snake.body.back();
+        if (!aligned && !(aligned = onCycle(snake))) {
+            // walk the cycle from wherever the head is; after a body length
+            // of such moves the whole snake lies on it
+            Vec2i next = cycle.after(head);
+            bool free = !snake.occupies(next) || (!snake.growNext && next == tail);
+            return free ? actionFor(next - head) : Action::None;
+        }
+
+        // distances are cycle steps ahead of the head: the tail is the far
+        // end of the free stretch, the food lies somewhere on it
+        const uint32_t n = (uint32_t)cycle.size();
+        const uint32_t toTail = cycle.distance(head, tail);
+        const uint32_t toFood = cycle.distance(head, g.food);
+        Vec2i best = cycle.after(head);
+
+        if ((float)snake.body.size() < shortcutFill * (float)n) {
+            // never past the food, and a few cells short of the tail so growth
+            // still to come has room
+            const uint32_t reach = std::min(toFood, toTail > shortcutGap ? toTail - shortcutGap : 0u);
+            uint32_t bestStep = 1;
+            for (Action a : {Action::Up, Action::Down, Action::Left, Action::Right}) {
+                Vec2i q = head + directionOf(a);
+                if (!snake.occupancy().inBounds(q) || snake.occupies(q)) continue;
+                uint32_t d = cycle.distance(head, q);
+                if (d > bestStep && d <= reach) {
+                    best = q;
+                    bestStep = d;
+                }
+            }
+        }
+        return actionFor(best - head);
+    }
+
+private:
+    // body cells consecutive along the cycle, tail to head
+    bool onCycle(const Snake& snake) const {
+        const SnakeBody& body = snake.body;
+        for (size_t i = 0; i + 1 < body.size(); ++i) {
+            if (!snake.occupancy().inBounds(body[i]) || cycle.distance(body[i + 1], body[i]) != 1) return false;
+        }
+        return snake.occupancy().inBounds(body.back());
+    }
+
+    HamiltonianCycle cycle;
+    bool aligned = false;
+};
@@ -0,0 +1,282 @@
+// headless.h
+// Runs GameState episodes with no window or rendering, as fast as possible,
+// and reports simulation throughput.
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include "arena.h"
+#include "autopilot.h"
+#include "batch_env.h"
+#include "fixed_board.h"
+#include "hamiltonian.h"
+#include "game_state.h"
+#include "observation.h"
+#include "telemetry.h"
+#include "thread_pool.h"
+
+// who steers headless games
+enum class Policy { Greedy, Autopilot, Cycle };
+
+inline const char* policyName(Policy p) {
+    return p == Policy::Greedy ? "greedy" : p == Policy::Autopilot ? "autopilot" : "cycle";
+}
+
+inline bool parsePolicy(const char* name, Policy& out) {
+    if (!std::strcmp(name, "greedy")) out = Policy::Greedy;
+    else if (!std::strcmp(name, "autopilot")) out = Policy::Autopilot;
+    else if (!std::strcmp(name, "cycle")) out = Policy::Cycle;
+    else return false;
+    return true;
+}
+
+struct HeadlessOptions {
+    int episodes = 100;
+    Policy policy = Policy::Greedy;
+    int envs = 0;         // > 0 steps that many games at once with BatchEnv
+    unsigned threads = 0; // batch worker threads, 0 = all cores
+    int snakes = 0;       // > 1 runs an arena with that many greedy snakes instead
+    uint64_t arenaTicks = 10000;
+    bool fixedBoards = true; // greedy runs on a size with a FixedGameState use it
+    bool observe = false;    // batch runs also encode every step's observations, as a trainer would
+    const char* telemetryPath = nullptr; // single-game runs log every tick there (telemetry.h)
+};
+
+// Cheap scripted player: move toward the food, avoiding moves that die on the
+// next tick when possible. occupied(p) reports body cells; the tail cell frees
+// up this tick unless the snake is growing.
+template <class Occupied>
+Action greedyStep(Vec2i head, Vec2i dir, Vec2i food, Vec2i tail, bool tailMoves, int cols, int rows, Occupied occupied) {
+    static constexpr Action actions[] = {Action::Up, Action::Down, Action::Left, Action::Right};
+    Action best = Action::None;
+    int bestDist = 0;
+    for (Action a : actions) {
+        Vec2i d = directionOf(a);
+        if (d == Vec2i(-dir.x, -dir.y)) continue; // reversing is ignored anyway
+        Vec2i next = head + d;
+        if (next.x < 0 || next.x >= cols || next.y < 0 || next.y >= rows) continue;
+        if (occupied(next) && !(tailMoves && next == tail)) continue;
+        int dist = std::abs(next.x - food.x) + std::abs(next.y - food.y);
+        if (best == Action::None || dist < bestDist) {
+            best = a;
+            bestDist = dist;
+        }
+    }
+    return best;
+}
+
+inline Action greedyAction(const GameState& g) {
+    const Snake& snake = g.snake;
+    return greedyStep(snake.head(), snake.dir, g.food, snake.body.back(), !snake.growNext, g.cfg.cols, g.cfg.rows,
+                      [&](Vec2i p) { return snake.occupies(p); });
+}
+
+template <int Cols, int Rows>
+Action greedyAction(const FixedGameState<Cols, Rows>& g) {
+    return greedyStep(g.head(), g.dir, g.food, g.tail(), !g.growNext, Cols, Rows, [&](Vec2i p) { return g.occupied(p); });
+}
+
+inline Action greedyAction(const BatchEnv& env, size_t k) {
+    return greedyStep(env.head(k), env.direction(k), env.foodCell(k), env.tail(k), env.tailMovesNext(k), env.width(),
+                      env.height(), [&](Vec2i p) { return env.occupied(k, p); });
+}
+
+// arena snake i: nearest food, every body counts as an obstacle except its
+// own moving tail
+inline Action greedyAction(const ArenaState& arena, size_t i) {
+    const ArenaSnake& s = arena.snakes[i];
+    if (!s.alive) return Action::None;
+    const Vec2i head = s.body.front();
+    Vec2i food = head;
+    int best = -1;
+    for (Vec2i f : arena.foods) {
+        int d = std::abs(f.x - head.x) + std::abs(f.y - head.y);
+        if (f.x >= 0 && (best < 0 || d < best)) {
+            best = d;
+            food = f;
+        }
+    }
+    return greedyStep(head, s.dir, food, s.body.back(), !s.growNext, arena.cfg.cols, arena.cfg.rows,
+                      [&](Vec2i p) { return arena.occupied(p); });
+}
+
+// greedy snakes in one arena for opt.arenaTicks ticks
+inline int runHeadlessArena(const GameConfig& cfg, const HeadlessOptions& opt) {
+    ArenaConfig arenaCfg;
+    arenaCfg.snakes = opt.snakes;
+    ArenaState arena(cfg, arenaCfg);
+    std::vector<Action> actions(arena.snakes.size());
+
+    uint64_t snakeTicks = 0;
+    auto t0 = std::chrono::steady_clock::now();
+    for (uint64_t t = 0; t < opt.arenaTicks; ++t) {
+        for (size_t i = 0; i < actions.size(); ++i) actions[i] = greedyAction(arena, i);
+        snakeTicks += arena.aliveCount();
+        arena.step(actions.data());
+    }
+    double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+    uint64_t deaths = 0, kills = 0;
+    size_t longest = 0;
+    for (const ArenaSnake& s : arena.snakes) {
+        deaths += s.deaths;
+        kills += s.kills;
+        longest = std::max(longest, s.body.size());
+    }
+    std::printf("headless: arena of %d snakes, %llu ticks in %.3f s (%.0f ticks/sec, %.0f snake moves/sec)\n",
+                arenaCfg.snakes, (unsigned long long)opt.arenaTicks, secs, secs > 0 ? opt.arenaTicks / secs : 0.0,
+                secs > 0 ? snakeTicks / secs : 0.0);
+    std::printf("          %llu deaths, %llu kills, longest snake now %zu\n", (unsigned long long)deaths,
+                (unsigned long long)kills, longest);
+    return 0;
+}
+
+// K environments stepped together on a thread pool until opt.episodes finished
+inline int runHeadlessBatch(const GameConfig& cfg, const HeadlessOptions& opt) {
+    BatchEnvOptions envOpts;
+    envOpts.starveTicks = (uint32_t)cfg.cols * cfg.rows * 2;
+    BatchEnv env(cfg, (size_t)opt.envs, envOpts);
+    ThreadPool pool(opt.threads);
+    std::vector<Action> actions(env.size());
+    std::vector<StepResult> results(env.size());
+    obs::Encoder encoder(cfg.cols, cfg.rows);
+    std::vector<float> observations(opt.observe ? env.size() * encoder.size() : 0);
+
+    uint64_t totalTicks = 0;
+    long long totalScore = 0;
+    int finished = 0;
+    int wins = 0;
+    auto t0 = std::chrono::steady_clock::now();
+    while (finished < opt.episodes) {
+        pool.parallelFor(env.size(), [&](size_t begin, size_t end) {
+            for (size_t k = begin; k < end; ++k) actions[k] = greedyAction(env, k);
+        });
+        env.step(actions.data(), results.data(), &pool);
+        if (opt.observe) encoder.encode(env, observations.data(), &pool);
+        totalTicks += env.size();
+        for (size_t k = 0; k < env.size(); ++k) {
+            if (!env.done(k)) continue;
+            ++finished;
+            totalScore += env.scoreOf(k);
+            if (results[k] == StepResult::Won) ++wins;
+        }
+    }
+    double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+    std::printf("headless: %d envs on %u threads, %d episodes, %llu ticks in %.3f s (%.0f ticks/sec)\n", opt.envs,
+                pool.size(), finished, (unsigned long long)totalTicks, secs, secs > 0 ? totalTicks / secs : 0.0);
+    std::printf("          mean score %.1f, %d wins\n", finished > 0 ? (double)totalScore / finished : 0.0, wins);
+    if (opt.observe) std::printf("          with a %zu-float observation per env per tick\n", encoder.size());
+    return 0;
+}
+
+// greedy episodes on a compile-time board, as the GameState loop below
+template <int Cols, int Rows>
+int runHeadlessFixed(const GameConfig& cfg, const HeadlessOptions& opt) {
+    auto game = std::make_unique<FixedGameState<Cols, Rows>>(cfg);
+    const uint64_t starveLimit = (uint64_t)Cols * Rows * 2;
+
+    uint64_t totalTicks = 0;
+    long long totalScore = 0;
+    int wins = 0;
+    auto t0 = std::chrono::steady_clock::now();
+    for (int e = 0; e < opt.episodes; ++e) {
+        game->cfg.moveInterval = cfg.moveInterval;
+        game->reset();
+        uint64_t lastMeal = 0;
+        while (!game->gameOver && game->tick - lastMeal < starveLimit)
+            if (game->step(greedyAction(*game)) == StepResult::Ate) lastMeal = game->tick;
+        totalTicks += game->tick;
+        totalScore += game->score;
+        if (game->won) ++wins;
+    }
+    double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+    std::printf("headless: greedy on a fixed %dx%d board, %d episodes, %llu ticks in %.3f s (%.0f ticks/sec)\n", Cols, Rows,
+                opt.episodes, (unsigned long long)totalTicks, secs, secs > 0 ? totalTicks / secs : 0.0);
+    std::printf("          mean score %.1f, %d wins\n", opt.episodes > 0 ? (double)totalScore / opt.episodes : 0.0, wins);
+    return 0;
+}
+
+// the board sizes compiled in (add an instantiation here for another);
+// returns -1 when cfg's size isn't one of them
+inline int runHeadlessFixedSize(const GameConfig& cfg, const HeadlessOptions& opt) {
+    if (cfg.cols == 32 && cfg.rows == 24) return runHeadlessFixed<32, 24>(cfg, opt);
+    if (cfg.cols == 64 && cfg.rows == 64) return runHeadlessFixed<64, 64>(cfg, opt);
+    if (cfg.cols == 256 && cfg.rows == 256) return runHeadlessFixed<256, 256>(cfg, opt);
+    return -1;
+}
+
+inline int runHeadless(const GameConfig& cfg, const HeadlessOptions& opt) {
+    if (opt.snakes > 1) return runHeadlessArena(cfg, opt);
+    if (opt.envs > 0) {
+        if (opt.policy != Policy::Greedy) {
+            std::fprintf(stderr, "--envs batches only run the greedy policy\n");
+            return 1;
+        }
+        return runHeadlessBatch(cfg, opt);
+    }
+    if (opt.policy == Policy::Greedy && opt.fixedBoards && !opt.telemetryPath) {
+        const int rc = runHeadlessFixedSize(cfg, opt);
+        if (rc >= 0) return rc;
+    }
+    GameState game(cfg);
+    Autopilot pilot;
+    CyclePlayer cycle;
+    if (opt.policy == Policy::Cycle && !cycle.prepare(cfg.cols, cfg.rows)) {
+        std::fprintf(stderr, "a %dx%d board has no Hamiltonian cycle (cols * rows must be even)\n", cfg.cols, cfg.rows);
+        return 1;
+    }
+    // end episodes that stop eating, the greedy player can circle forever
+    const uint64_t starveLimit = (uint64_t)cfg.cols * cfg.rows * 2;
+    Telemetry telemetry;
+    if (opt.telemetryPath && !telemetry.open(opt.telemetryPath, cfg)) {
+        std::fprintf(stderr, "can't write telemetry %s\n", opt.telemetryPath);
+        return 1;
+    }
+
+    uint64_t totalTicks = 0;
+    long long totalScore = 0;
+    int wins = 0;
+    auto t0 = std::chrono::steady_clock::now();
+    for (int e = 0; e < opt.episodes; ++e) {
+        game.cfg = cfg;
+        game.reset();
+        pilot.clear();
+        cycle.clear();
+        uint64_t lastMeal = 0;
+        while (!game.gameOver && game.tick - lastMeal < starveLimit) {
+            Action a = Action::None;
+            if (opt.policy == Policy::Cycle) a = cycle.decide(game);
+            if (opt.policy == Policy::Autopilot || (opt.policy == Policy::Cycle && a == Action::None)) a = pilot.decide(game);
+            else if (opt.policy == Policy::Greedy) a = greedyAction(game);
+            StepResult r;
+            if (telemetry.active()) {
+                // with no frames to miss, wait for the writer rather than drop ticks
+                const auto s0 = std::chrono::steady_clock::now();
+                r = game.step(a);
+                const float us = std::chrono::duration<float, std::micro>(std::chrono::steady_clock::now() - s0).count();
+                telemetry.record(game, r, us, 0.f, true);
+            } else {
+                r = game.step(a);
+            }
+            if (r == StepResult::Ate) lastMeal = game.tick;
+        }
+        totalTicks += game.tick;
+        totalScore += game.score;
+        if (game.won) ++wins;
+    }
+    double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+    std::printf("headless: %s, %d episodes, %llu ticks in %.3f s (%.0f ticks/sec)\n", policyName(opt.policy),
+                opt.episodes, (unsigned long long)totalTicks, secs, secs > 0 ? totalTicks / secs : 0.0);
+    std::printf("          mean score %.1f, %d wins\n", opt.episodes > 0 ? (double)totalScore / opt.episodes : 0.0, wins);
+    return 0;
+}
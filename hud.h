@@ -0,0 +1,79 @@
+// hud.h
+// Score line, help line and the game-over banner. The fixed strings are built
+// once as sf::Text; the score digits come from a glyph atlas and are only
+// rewritten when the score changes, so a steady frame does no text work.
+
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <utility>
+
+#include "render.h"
+
+enum class HudMode { Playing, Paused, GameOver, Won };
+
+class Hud {
+public:
+    Hud(const sf::Font& font, sf::Vector2f windowSize)
+        : digits(font, 18),
+          scoreLabel(font, "Score: ", 18),
+          playingInfo(font, "[Arrows/WASD] Move  [P] Pause  [R] Restart\n[F2] Auto  [F3] Stats  [Esc] Quit", 20),
+          pausedInfo(font, "[P] Resume  [R] Restart  [Esc] Quit  (Paused)", 20),
+          overInfo(font, "[R] Restart  [Esc] Quit", 20),
+          gameOverText(font, "Game Over", 36),
+          wonText(font, "You Win!", 36) {
+        scoreLabel.setPosition(sf::Vector2f(8.f, 4.f));
+        digitsPos = sf::Vector2f(8.f + digits.measure("Score: "), 4.f); // where sf::Text's pen stops
+        for (sf::Text* t : {&playingInfo, &pausedInfo, &overInfo}) t->setPosition(sf::Vector2f(8.f, windowSize.y - 28.f));
+        // two rows, so the whole line fits the default 640 px window
+        playingInfo.setPosition(sf::Vector2f(8.f, windowSize.y - 28.f - font.getLineSpacing(20)));
+        for (sf::Text* t : {&gameOverText, &wonText})
+            t->setPosition(sf::Vector2f(windowSize.x / 2.f - t->getGlobalBounds().size.x / 2.f, windowSize.y / 2.f - 40.f));
+    }
+
+    // cheap when nothing changed
+    void update(int score, HudMode m) {
+        mode = m;
+        if (score == shownScore) return;
+        shownScore = score;
+        char buf[16];
+        int n = 0;
+        unsigned v = score < 0 ? 0u : (unsigned)score;
+        do {
+            buf[n++] = (char)('0' + v % 10);
+            v /= 10;
+        } while (v && n < 15);
+        for (int i = 0; i < n / 2; ++i) std::swap(buf[i], buf[n - 1 - i]);
+        buf[n] = '\0';
+        digitQuads.clear();
+        digits.write(digitQuads, buf, digitsPos, sf::Color::White);
+    }
+
+    // returns the number of draw calls issued
+    int draw(sf::RenderTarget& target) const {
+        target.draw(scoreLabel);
+        int calls = 1 + digitQuads.draw(target, sf::RenderStates(&digits.texture()));
+        switch (mode) {
+            case HudMode::Playing: target.draw(playingInfo); return calls + 1;
+            case HudMode::Paused: target.draw(pausedInfo); return calls + 1;
+            case HudMode::GameOver: target.draw(gameOverText); break;
+            case HudMode::Won: target.draw(wonText); break;
+        }
+        target.draw(overInfo);
+        return calls + 2;
+    }
+
+private:
+    GlyphAtlas digits;
+    QuadBatch digitQuads;
+    sf::Vector2f digitsPos;
+    int shownScore = -1;
+    HudMode mode = HudMode::Playing;
+
+    sf::Text scoreLabel;
+    sf::Text playingInfo;
+    sf::Text pausedInfo;
+    sf::Text overInfo;
+    sf::Text gameOverText;
+    sf::Text wonText;
+};
@@ -0,0 +1,52 @@
+// input_queue.h
+// Small fixed-size queue of timestamped direction changes. Presses are queued
+// as they arrive and the logic consumes one per tick, so two quick presses
+// inside one moveInterval turn twice instead of overwriting each other. Each
+// press is checked against the direction the snake will have once the
+// presses already queued are applied, not the stale current one, so a fast
+// up-left on a right-moving snake can't sneak in a reversal.
+
+#pragma once
+
+#include <cstdint>
+
+#include "game_state.h"
+
+class InputQueue {
+public:
+    static constexpr int capacity = 4;
+
+    struct Entry {
+        Action action = Action::None;
+        int64_t timeUs = 0; // when it was pressed, on the caller's clock
+    };
+
+    void clear() { count = 0; }
+    bool empty() const { return count == 0; }
+
+    // queue a press; returns false when it is dropped (queue full, no change
+    // of direction, or a reversal of the last queued direction)
+    bool push(Action a, int64_t timeUs, Vec2i currentDir, size_t snakeLength) {
+        if (a == Action::None || count == capacity) return false;
+        Vec2i last = count > 0 ? directionOf(entries[(head + count - 1) % capacity].action) : currentDir;
+        Vec2i d = directionOf(a);
+        if (d == last) return false;
+        if (snakeLength > 1 && d == Vec2i(-last.x, -last.y)) return false;
+        entries[(head + count) % capacity] = {a, timeUs};
+        ++count;
+        return true;
+    }
+
+    bool pop(Entry& out) {
+        if (count == 0) return false;
+        out = entries[head];
+        head = (head + 1) % capacity;
+        --count;
+        return true;
+    }
+
+private:
+    Entry entries[capacity];
+    int head = 0;
+    int count = 0;
+};
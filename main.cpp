@@ -3,237 +3,749 @@
 // Build with: cmake .. && make   (or use g++ + pkg-config)
 
 #include <SFML/Graphics.hpp>
-#include <vector>
-#include <deque>
-#include <random>
-#include <string>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <cstdio>
 #include <chrono>
-
-using Vec2i = sf::Vector2i;
-
-struct GameConfig {
-    int cellSize = 20;
-    int cols = 32; // grid width
-    int rows = 24; // grid height
-    float moveInterval = 0.12f; // seconds per move (smaller => faster)
+#include <iostream>
+
+#include "alloc_counter.h"
+#include "arena.h"
+#include "assets.h"
+#include "autopilot.h"
+#include "frame_arena.h"
+#include "hamiltonian.h"
+#include "game_state.h"
+#include "headless.h"
+#include "hud.h"
+#include "input_queue.h"
+#include "net.h"
+#include "perf_overlay.h"
+#include "profiler.h"
+#include "render.h"
+#include "replay.h"
+#include "telemetry.h"
+
+enum class Pacing {
+    VSync,    // wait for the display's refresh
+    Cap,      // fixed frame-rate cap (--fps)
+    Uncapped, // as fast as possible, for benchmarking
+    OnDemand  // redraw only when a tick or an event changed something
 };
 
-class Snake {
-public:
-    std::deque<Vec2i> body; // front is head
-    Vec2i dir{1, 0};
-    bool growNext = false;
+static bool parsePacing(const char* name, Pacing& out) {
+    if (!std::strcmp(name, "vsync")) out = Pacing::VSync;
+    else if (!std::strcmp(name, "cap")) out = Pacing::Cap;
+    else if (!std::strcmp(name, "uncapped")) out = Pacing::Uncapped;
+    else if (!std::strcmp(name, "ondemand")) out = Pacing::OnDemand;
+    else return false;
+    return true;
+}
+
+static void printUsage(const char* argv0) {
+    std::cout << "usage: " << argv0 << " [options]\n"
+                 "  --seed N            seed food placement (default: from the clock, printed at startup)\n"
+                 "  --rng NAME          random generator, pcg32 (default) or xoshiro256\n"
+                 "  --pacing MODE       vsync, cap (default), uncapped or ondemand\n"
+                 "  --fps N             frame cap for --pacing cap (default 120)\n"
+                 "  --cols N, --rows N  board size in cells (default 32 x 24); larger boards scroll\n"
+                 "  --cell N            cell size in pixels (default 20)\n"
+                 "  --no-shader         draw the board without the fragment shader path\n"
+                 "  --input-hz N        cap pacing: poll input (and run due ticks) N times a second between frames\n"
+                 "  --assert-no-alloc   abort when a steady frame allocates (debug builds)\n"
+                 "  --headless          run the simulation without a window and report ticks/sec\n"
+                 "  --episodes N        number of headless episodes (default 100)\n"
+                 "  --envs K            headless: step K games at once as a batch\n"
+                 "  --threads N         headless batch worker threads (default: all cores)\n"
+                 "  --observe           with --envs, also encode observation planes every step\n"
+                 "  --no-fixed          headless greedy: skip the compile-time 32x24 / 64x64 / 256x256 boards\n"
+                 "  --policy NAME       who steers: greedy (headless default), autopilot or cycle; F2 in the window\n"
+                 "  --record FILE       save the session's seed and inputs to FILE on exit\n"
+                 "  --telemetry FILE    log every tick (head, length, score, deaths, timings) to binary FILE\n"
+                 "  --trace FILE        SNAKE_PROFILE builds: write the Chrome trace to FILE (default snake_trace.json)\n"
+                 "  --replay FILE       play back a recorded session (with --headless: re-simulate it and report)\n"
+                 "  --seek TICK         replay: fast-forward to TICK and start paused there\n"
+                 "  --snakes N          arena: you and N - 1 bots on one board (with --headless: N bots)\n"
+                 "  --ticks N           headless arena length in ticks (default 10000)\n"
+                 "  --serve PORT        run matches for network clients on UDP PORT (52000 by convention)\n"
+                 "  --max-matches N     matches one server hosts at once (default 256)\n"
+                 "  --connect HOST      play on a server, HOST[:PORT]\n"
+                 "  --no-predict        with --connect, show only server-confirmed ticks\n";
+}
+
+// The embedded UI font, with the glyphs of every size the HUD (18, 20, 36)
+// and the perf overlay (13) use already rasterized.
+static const sf::Font& loadFont() {
+    Assets& assets = Assets::get();
+    static bool warmed = false;
+    if (!assets.fontLoaded()) std::cerr << "embedded font failed to load; text is hidden\n";
+    else if (!warmed) assets.prewarm({13, 18, 20, 36});
+    warmed = true;
+    return assets.font();
+}
+
+// Sleep in waitEvent() until an event arrives, or until timeout when it is not
+// zero, and hand the event to onEvent; returns whether one came. Windows call
+// this instead of drawing while the picture can't change (paused, game over).
+template <class OnEvent>
+static bool sleepUntilEvent(sf::RenderWindow& window, sf::Time timeout, OnEvent&& onEvent) {
+    SNAKE_ZONE("wait");
+    if (const auto event = window.waitEvent(timeout)) {
+        onEvent(*event);
+        return true;
+    }
+    return false;
+}
+
+// --snakes N: the player steers snake 0 among N - 1 greedy bots (F2 hands it
+// to a bot too). Dead snakes come back after a short wait; R starts a new
+// round. Drawn through the same camera and culled batches as a single game,
+// coloured per snake from the arena's owner grid.
+static int runArenaWindow(const GameConfig& cfg, const ArenaConfig& arenaCfg, Pacing pacing, int fps) {
+    ArenaState arena(cfg, arenaCfg);
+    const int windowW = std::min(cfg.cellSize * cfg.cols, 1280);
+    const int windowH = std::min(cfg.cellSize * cfg.rows, 960);
+    sf::RenderWindow window(sf::VideoMode(sf::Vector2u(windowW, windowH)), "SFML Snake Arena");
+    window.setVerticalSyncEnabled(pacing == Pacing::VSync);
+    window.setFramerateLimit(pacing == Pacing::Cap ? (unsigned)fps : 0);
+
+    const sf::Font& font = loadFont();
+    Hud hud(font, sf::Vector2f((float)windowW, (float)windowH));
+    PerfOverlay overlay(font);
+    FrameStats stats;
+    FrameArena frameArena(64 * 1024);
+
+    GridBackground background;
+    QuadBatch entities;
+    entities.reserve((size_t)(windowW / cfg.cellSize + 2) * (windowH / cfg.cellSize + 2) + arena.snakes.size());
+    bool entitiesDirty = true;
+    sf::View camera(sf::FloatRect({0.f, 0.f}, {(float)windowW, (float)windowH}));
+
+    std::vector<Action> actions(arena.snakes.size());
+    InputQueue inputs;
+    sf::Clock inputClock;
+    bool paused = false;
+    bool playerBot = false;
+    sf::Clock moveClock, frameClock, sectionClock;
+    float acc = 0.f;
+    bool needRedraw = true; // anything but pointer motion may change what is on screen
+    const ArenaSnake& me = arena.snakes[0];
+    // paused, or every snake dead for good: nothing moves until a key arrives
+    auto idle = [&] { return paused || (arena.aliveCount() == 0 && arena.opts.respawnTicks == 0); };
+    // arenas aren't interpolated, so a frame between ticks repeats the last
+    // one; uncapped then paces like on demand and draws once per change
+    const bool onDemand = pacing == Pacing::OnDemand || pacing == Pacing::Uncapped;
+
+    auto handleEvent = [&](const sf::Event& event) {
+        if (!event.is<sf::Event::MouseMoved>()) needRedraw = true;
+        if (event.is<sf::Event::Closed>()) window.close();
+        if (const auto* keyPressed = event.getIf<sf::Event::KeyPressed>()) {
+            if (keyPressed->code == sf::Keyboard::Key::Escape) window.close();
+            if (keyPressed->code == sf::Keyboard::Key::P) paused = !paused;
+            if (keyPressed->code == sf::Keyboard::Key::F2) {
+                playerBot = !playerBot;
+                inputs.clear();
+            }
+            if (keyPressed->code == sf::Keyboard::Key::F3) overlay.toggle();
+            if (keyPressed->code == sf::Keyboard::Key::R) {
+                arena.reset();
+                inputs.clear();
+                paused = false;
+                entitiesDirty = true;
+                moveClock.restart();
+            }
+            if (!paused && !playerBot && me.alive) {
+                Action a = Action::None;
+                if (keyPressed->code == sf::Keyboard::Key::Up || keyPressed->code == sf::Keyboard::Key::W) a = Action::Up;
+                if (keyPressed->code == sf::Keyboard::Key::Down || keyPressed->code == sf::Keyboard::Key::S) a = Action::Down;
+                if (keyPressed->code == sf::Keyboard::Key::Left || keyPressed->code == sf::Keyboard::Key::A) a = Action::Left;
+                if (keyPressed->code == sf::Keyboard::Key::Right || keyPressed->code == sf::Keyboard::Key::D) a = Action::Right;
+                inputs.push(a, inputClock.getElapsedTime().asMicroseconds(), me.dir, me.body.size());
+            }
+        }
+    };
 
-    Snake(Vec2i start, int initialLength = 4) {
-        for (int i = 0; i < initialLength; ++i) {
-            body.push_back({start.x - i, start.y});
+    while (window.isOpen()) {
+        frameArena.reset();
+        stats.ticks = 0;
+
+        // idle: sleep until a key arrives; on demand: until the next tick or event
+        if ((idle() || onDemand) && !needRedraw) {
+            sf::Time timeout = sf::Time::Zero; // no timeout
+            if (!idle()) timeout = sf::seconds(std::max(cfg.moveInterval - acc - moveClock.getElapsedTime().asSeconds(), 1e-6f));
+            sleepUntilEvent(window, timeout, handleEvent);
+            frameClock.restart(); // the graph shows frame work, not time spent asleep
         }
-    }
+        while (const auto event = window.pollEvent()) handleEvent(*event);
 
-    Vec2i head() const { return body.front(); }
+        // --- Update ---
+        sectionClock.restart();
+        if (idle()) {
+            moveClock.restart(); // no jump when play resumes
+        } else {
+            acc += moveClock.restart().asSeconds();
+            while (acc >= cfg.moveInterval) {
+                acc -= cfg.moveInterval;
+                for (size_t i = 0; i < actions.size(); ++i) actions[i] = greedyAction(arena, i);
+                InputQueue::Entry press;
+                if (!playerBot) actions[0] = inputs.pop(press) ? press.action : Action::None;
+                arena.step(actions.data());
+                ++stats.ticks;
+                entitiesDirty = true;
+                needRedraw = true;
+            }
+        }
+        stats.updateMs = sectionClock.restart().asSeconds() * 1000.f;
+        if (!needRedraw && (idle() || onDemand)) continue;
+        needRedraw = false;
 
-    void setDirection(const Vec2i& d) {
-        // prevent reversing
-        if (body.size() > 1 && d == Vec2i(-dir.x, -dir.y)) return;
-        dir = d;
+        // --- Render ---
+        int drawCalls = 0;
+        window.clear(palette::clear);
+        // follow snake 0; while it waits to respawn the camera stays put
+        if (me.alive) camera.setCenter(followCenter(me.body, cfg, 1.f, camera.getSize()));
+        window.setView(camera);
+        background.update(cfg);
+        drawCalls += background.draw(window);
+        if (entitiesDirty) {
+            buildArenaEntities(entities, arena, visibleCells(camera, cfg.cellSize, cfg.cols, cfg.rows));
+            entitiesDirty = false;
+        }
+        drawCalls += entities.draw(window);
+        window.setView(window.getDefaultView());
+
+        hud.update(me.score, paused ? HudMode::Paused : me.alive ? HudMode::Playing : HudMode::GameOver);
+        drawCalls += hud.draw(window);
+        drawCalls += overlay.draw(window, frameArena);
+        stats.drawCalls = drawCalls;
+        stats.renderMs = sectionClock.restart().asSeconds() * 1000.f;
+        window.display();
+        stats.frameMs = frameClock.restart().asSeconds() * 1000.f;
+        overlay.record(stats);
     }
-
-    void move() {
-        Vec2i newHead = head() + dir;
-        body.push_front(newHead);
-        if (!growNext) body.pop_back();
-        growNext = false;
+    return 0;
+}
+
+// --connect HOST: a client for a --serve process. Presses show at once on a
+// predicted copy of the match that the server's ticks correct; with
+// --no-predict it only shows what the server confirmed.
+static int runClientWindow(const GameConfig& cfg, const char* host, bool predict, Pacing pacing, int fps) {
+    net::Client client(cfg, predict);
+    if (!client.connect(host)) {
+        std::cerr << "can't reach " << host << "\n";
+        return 1;
     }
+    const int windowW = std::min(cfg.cellSize * cfg.cols, 1280);
+    const int windowH = std::min(cfg.cellSize * cfg.rows, 960);
+    sf::RenderWindow window(sf::VideoMode(sf::Vector2u(windowW, windowH)), "SFML Snake Client");
+    window.setVerticalSyncEnabled(pacing == Pacing::VSync);
+    window.setFramerateLimit(pacing == Pacing::Cap ? (unsigned)fps : 0);
+
+    const sf::Font& font = loadFont();
+    Hud hud(font, sf::Vector2f((float)windowW, (float)windowH));
+    GridBackground background;
+    QuadBatch entities;
+    sf::View camera(sf::FloatRect({0.f, 0.f}, {(float)windowW, (float)windowH}));
+    bool dirty = true;      // the entities need rebuilding
+    bool needRedraw = true; // anything but pointer motion, or a new state, changes the picture
+    // an unchanged frame sleeps this long in waitEvent() before checking the socket again
+    const sf::Time netPoll = sf::milliseconds(2);
+
+    auto handleEvent = [&](const sf::Event& event) {
+        if (!event.is<sf::Event::MouseMoved>()) needRedraw = true;
+        if (event.is<sf::Event::Closed>()) window.close();
+        if (const auto* keyPressed = event.getIf<sf::Event::KeyPressed>()) {
+            if (keyPressed->code == sf::Keyboard::Key::Escape) window.close();
+            if (keyPressed->code == sf::Keyboard::Key::R) client.restart();
+            if (keyPressed->code == sf::Keyboard::Key::Up || keyPressed->code == sf::Keyboard::Key::W) client.press(Action::Up);
+            if (keyPressed->code == sf::Keyboard::Key::Down || keyPressed->code == sf::Keyboard::Key::S) client.press(Action::Down);
+            if (keyPressed->code == sf::Keyboard::Key::Left || keyPressed->code == sf::Keyboard::Key::A) client.press(Action::Left);
+            if (keyPressed->code == sf::Keyboard::Key::Right || keyPressed->code == sf::Keyboard::Key::D) client.press(Action::Right);
+        }
+    };
 
-    void grow() { growNext = true; }
-
-    bool collidesWithSelf() const {
-        Vec2i h = head();
-        for (size_t i = 1; i < body.size(); ++i)
-            if (body[i] == h) return true;
-        return false;
+    while (window.isOpen()) {
+        // nothing new since the last frame: wait for input or the next poll
+        if (!needRedraw) sleepUntilEvent(window, netPoll, handleEvent);
+        while (const auto event = window.pollEvent()) handleEvent(*event);
+        if (client.update()) {
+            dirty = true;
+            needRedraw = true;
+        }
+        if (client.busy()) {
+            std::cerr << "server has no free match\n";
+            return 1;
+        }
+        if (!needRedraw) continue;
+        needRedraw = false;
+
+        window.clear(palette::clear);
+        if (client.ready()) {
+            const GameState& game = client.state();
+            camera.setCenter(followCenter(game, 1.f, camera.getSize()));
+            window.setView(camera);
+            background.update(game.cfg);
+            background.draw(window);
+            if (dirty) buildVisibleEntities(entities, game, visibleCells(camera, game.cfg.cellSize, game.cfg.cols, game.cfg.rows));
+            dirty = false;
+            entities.draw(window);
+            window.setView(window.getDefaultView());
+            hud.update(game.score, !game.gameOver ? HudMode::Playing : game.won ? HudMode::Won : HudMode::GameOver);
+            hud.draw(window);
+        }
+        window.display();
     }
+    client.leave();
+    return 0;
+}
 
-    bool occupies(const Vec2i &p) const {
-        for (auto &s: body) if (s == p) return true;
-        return false;
+int main(int argc, char** argv) {
+    GameConfig cfg;
+    bool headless = false;
+    bool seeded = false;
+    bool assertNoAlloc = false;
+    int inputHz = 0;
+    Pacing pacing = Pacing::Cap;
+    int fps = 120;
+    HeadlessOptions headlessOpts;
+    const char* recordPath = nullptr;
+    const char* replayPath = nullptr;
+    uint64_t seekTick = 0;
+    net::ServerOptions serverOpts;
+    bool serve = false;
+    const char* connectHost = nullptr;
+    bool predict = true;
+    bool shaderBoardOn = true;
+    for (int i = 1; i < argc; ++i) {
+        if (!std::strcmp(argv[i], "--headless")) headless = true;
+        else if (!std::strcmp(argv[i], "--seed") && i + 1 < argc) {
+            cfg.seed = std::strtoull(argv[++i], nullptr, 10);
+            seeded = true;
+        } else if (!std::strcmp(argv[i], "--rng") && i + 1 < argc && parseRngKind(argv[i + 1], cfg.rngKind)) ++i;
+        else if (!std::strcmp(argv[i], "--assert-no-alloc")) assertNoAlloc = true;
+        else if (!std::strcmp(argv[i], "--input-hz") && i + 1 < argc) inputHz = std::atoi(argv[++i]);
+        else if (!std::strcmp(argv[i], "--pacing") && i + 1 < argc && parsePacing(argv[i + 1], pacing)) ++i;
+        else if (!std::strcmp(argv[i], "--fps") && i + 1 < argc) fps = std::max(1, std::atoi(argv[++i]));
+        else if (!std::strcmp(argv[i], "--cols") && i + 1 < argc) cfg.cols = std::max(2, std::atoi(argv[++i]));
+        else if (!std::strcmp(argv[i], "--rows") && i + 1 < argc) cfg.rows = std::max(2, std::atoi(argv[++i]));
+        else if (!std::strcmp(argv[i], "--cell") && i + 1 < argc) cfg.cellSize = std::max(2, std::atoi(argv[++i]));
+        else if (!std::strcmp(argv[i], "--episodes") && i + 1 < argc) headlessOpts.episodes = std::atoi(argv[++i]);
+        else if (!std::strcmp(argv[i], "--envs") && i + 1 < argc) headlessOpts.envs = std::atoi(argv[++i]);
+        else if (!std::strcmp(argv[i], "--threads") && i + 1 < argc) headlessOpts.threads = (unsigned)std::atoi(argv[++i]);
+        else if (!std::strcmp(argv[i], "--policy") && i + 1 < argc && parsePolicy(argv[i + 1], headlessOpts.policy)) ++i;
+        else if (!std::strcmp(argv[i], "--record") && i + 1 < argc) recordPath = argv[++i];
+        else if (!std::strcmp(argv[i], "--telemetry") && i + 1 < argc) headlessOpts.telemetryPath = argv[++i];
+        else if (!std::strcmp(argv[i], "--trace") && i + 1 < argc) profile::setOutput(argv[++i]);
+        else if (!std::strcmp(argv[i], "--replay") && i + 1 < argc) replayPath = argv[++i];
+        else if (!std::strcmp(argv[i], "--seek") && i + 1 < argc) seekTick = std::strtoull(argv[++i], nullptr, 10);
+        else if (!std::strcmp(argv[i], "--snakes") && i + 1 < argc) headlessOpts.snakes = std::atoi(argv[++i]);
+        else if (!std::strcmp(argv[i], "--ticks") && i + 1 < argc) headlessOpts.arenaTicks = std::strtoull(argv[++i], nullptr, 10);
+        else if (!std::strcmp(argv[i], "--serve") && i + 1 < argc) {
+            serverOpts.port = (unsigned short)std::atoi(argv[++i]);
+            serve = true;
+        } else if (!std::strcmp(argv[i], "--max-matches") && i + 1 < argc)
+            serverOpts.maxMatches = (size_t)std::max(1, std::atoi(argv[++i]));
+        else if (!std::strcmp(argv[i], "--connect") && i + 1 < argc) connectHost = argv[++i];
+        else if (!std::strcmp(argv[i], "--no-predict")) predict = false;
+        else if (!std::strcmp(argv[i], "--no-shader")) shaderBoardOn = false;
+        else if (!std::strcmp(argv[i], "--no-fixed")) headlessOpts.fixedBoards = false;
+        else if (!std::strcmp(argv[i], "--observe")) headlessOpts.observe = true;
+        else {
+            printUsage(argv[0]);
+            return std::strcmp(argv[i], "--help") ? 1 : 0;
+        }
+    }
+    if (headlessOpts.snakes > 1 && (recordPath || replayPath)) {
+        std::cerr << "arenas can't be recorded or replayed\n";
+        return 1;
+    }
+    if (headlessOpts.telemetryPath && (headlessOpts.snakes > 1 || headlessOpts.envs > 0 || serve || connectHost)) {
+        std::cerr << "--telemetry logs single games only\n";
+        return 1;
+    }
+    if (connectHost) return runClientWindow(cfg, connectHost, predict, pacing, fps);
+    if (serve) {
+        if (!net::Server::fits(cfg)) {
+            std::cerr << "a " << cfg.cols << "x" << cfg.rows << " board is too large to send in one datagram\n";
+            return 1;
+        }
+        if (!seeded) cfg.seed = (uint64_t)std::chrono::high_resolution_clock::now().time_since_epoch().count();
+        net::Server server(cfg, serverOpts);
+        return server.run();
+    }
+    Replay replay;
+    if (replayPath) {
+        if (!replay.load(replayPath)) {
+            std::cerr << "can't read replay " << replayPath << "\n";
+            return 1;
+        }
+        cfg = ReplayPlayer::configFor(replay, cfg);
+        seeded = true;
+    }
+    if (!seeded) cfg.seed = (uint64_t)std::chrono::high_resolution_clock::now().time_since_epoch().count();
+    std::cout << "seed " << cfg.seed << " (" << rngKindName(cfg.rngKind) << ")\n";
+    ReplayPlayer player(replay, cfg);
+    if (headless && replayPath) {
+        // the recorded session at full speed, for deterministic benchmarks
+        GameState game(cfg);
+        Telemetry telemetry;
+        if (headlessOpts.telemetryPath && !telemetry.open(headlessOpts.telemetryPath, cfg)) {
+            std::cerr << "can't write telemetry " << headlessOpts.telemetryPath << "\n";
+            return 1;
+        }
+        auto t0 = std::chrono::steady_clock::now();
+        uint64_t ticks = 0;
+        if (telemetry.active()) {
+            // tick by tick so each one is timed and logged, waiting for the writer as headless runs do
+            const uint64_t target = std::min<uint64_t>(seekTick ? seekTick : replay.ticks, replay.ticks);
+            for (; ticks < target; ++ticks) {
+                const auto s0 = std::chrono::steady_clock::now();
+                const StepResult r = player.advance(game);
+                const float us = std::chrono::duration<float, std::micro>(std::chrono::steady_clock::now() - s0).count();
+                telemetry.record(game, r, us, 0.f, true);
+            }
+            player.applyRestarts(game);
+        } else {
+            ticks = player.seek(game, seekTick ? seekTick : replay.ticks);
+        }
+        double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+        std::printf("replay: %llu ticks in %.3f s (%.0f ticks/sec), score %d%s\n", (unsigned long long)ticks, secs,
+                    secs > 0 ? (double)ticks / secs : 0.0, game.score, player.corrupted() ? " (event stream corrupt)" : "");
+        return player.corrupted() ? 1 : 0;
+    }
+    if (headless) return runHeadless(cfg, headlessOpts);
+    if (headlessOpts.snakes > 1) {
+        ArenaConfig arenaCfg;
+        arenaCfg.snakes = headlessOpts.snakes;
+        return runArenaWindow(cfg, arenaCfg, pacing, fps);
     }
-};
-
-struct RNG {
-    std::mt19937 gen;
-    RNG() : gen((unsigned)std::chrono::high_resolution_clock::now().time_since_epoch().count()) {}
-    int nextInt(int a, int b) { std::uniform_int_distribution<int> d(a, b); return d(gen); }
-};
 
-int main() {
-    GameConfig cfg;
-    // Adjust resolution for retina / scaling if desired
-    int windowW = cfg.cellSize * cfg.cols;
-    int windowH = cfg.cellSize * cfg.rows;
+    // Adjust resolution for retina / scaling if desired. Boards larger than
+    // this scroll under a camera that follows the head.
+    int windowW = std::min(cfg.cellSize * cfg.cols, 1280);
+    int windowH = std::min(cfg.cellSize * cfg.rows, 960);
     sf::RenderWindow window(sf::VideoMode(sf::Vector2u(windowW, windowH)), "SFML Snake");
-    window.setFramerateLimit(120);
-
-    // Prepare grid rectangles
-    sf::RectangleShape cellShape(sf::Vector2f((float)cfg.cellSize - 1.0f, (float)cfg.cellSize - 1.0f));
-    cellShape.setOutlineThickness(0);
-
-    // Start snake centered
-    Vec2i startPos(cfg.cols / 2, cfg.rows / 2);
-    Snake snake(startPos, 5);
+    // with --input-hz the loop paces itself so it can poll while it waits
+    const bool selfPaced = pacing == Pacing::Cap && inputHz > 0;
+    const sf::Time frameBudget = sf::seconds(1.f / (float)fps);
+    window.setVerticalSyncEnabled(pacing == Pacing::VSync);
+    window.setFramerateLimit(pacing == Pacing::Cap && !selfPaced ? (unsigned)fps : 0);
+
+    // Prepare grid background and the batch for food + snake
+    GridBackground background;
+    QuadBatch entities;
+    // every visible cell plus food and the interpolated tail, so filling it never allocates
+    entities.reserve((size_t)(windowW / cfg.cellSize + 2) * (windowH / cfg.cellSize + 2) + 2);
+    bool entitiesDirty = true; // rebuild the batch only after the board or the visible cells changed
+    sf::View camera(sf::FloatRect({0.f, 0.f}, {(float)windowW, (float)windowH}));
+    sf::IntRect shownCells; // what the entity batch was built for
+    // the board from a shader where there is one, else boards that fit in
+    // one texture are kept there and patched per tick; either way the entity
+    // batch then holds just food, head and tail
+    ShaderBoard shaderBoard;
+    BoardCanvas canvas;
+    const bool useShader = shaderBoardOn && shaderBoard.prepare(cfg);
+    const bool useCanvas = !useShader && canvas.prepare(cfg);
+
+    GameState game(cfg);
+    bool paused = false;
+    const bool playback = replayPath != nullptr;
+    if (playback && seekTick > 0) {
+        // run the simulation up to the requested tick and show only that frame
+        player.seek(game, seekTick);
+        paused = true;
+    }
+    ReplayRecorder recorder;
+    if (recordPath) recorder.begin(cfg);
 
-    RNG rng;
-    Vec2i food;
-    auto placeFood = [&](void) {
-        while (true) {
-            int x = rng.nextInt(0, cfg.cols - 1);
-            int y = rng.nextInt(0, cfg.rows - 1);
-            if (!snake.occupies({x, y})) { food = {x, y}; break; }
-        }
-    };
-    placeFood();
+    const sf::Font& font = loadFont();
 
-    int score = 0;
-    bool paused = false;
-    bool gameOver = false;
+    Hud hud(font, sf::Vector2f((float)windowW, (float)windowH));
 
-    sf::Font font;
-    // Use SFML default fallback if no font; try to load an OS font for nicer text.
-    if (!font.openFromFile("/System/Library/Fonts/Supplemental/Arial.ttf")) {
-        // fallback: try a generic one (may fail on some setups)
-        (void)font.openFromFile("/Library/Fonts/Arial.ttf");
+    PerfOverlay overlay(font);
+    FrameStats stats;
+    sf::Clock frameClock;
+    sf::Clock sectionClock;
+    Telemetry telemetry;
+    if (headlessOpts.telemetryPath && !telemetry.open(headlessOpts.telemetryPath, cfg)) {
+        std::cerr << "can't write telemetry " << headlessOpts.telemetryPath << "\n";
+        return 1;
     }
+    // one tick's step(), timed only when it is logged
+    auto timedStep = [&](auto&& step) {
+        if (!telemetry.active()) return step();
+        const auto t0 = std::chrono::steady_clock::now();
+        const StepResult r = step();
+        const float us = std::chrono::duration<float, std::micro>(std::chrono::steady_clock::now() - t0).count();
+        telemetry.record(game, r, us, stats.frameMs);
+        return r;
+    };
 
-    sf::Text scoreText(font);
-    scoreText.setCharacterSize(18);
-    scoreText.setPosition(sf::Vector2f(8.f, 4.f));
-
-    sf::Text infoText(font);
-    infoText.setCharacterSize(20);
-    infoText.setPosition(sf::Vector2f(8.f, (float)(windowH - 28)));
+    // scratch memory for one frame; nothing in the loop below touches the heap
+    FrameArena arena(64 * 1024);
+    // --assert-no-alloc skips the first frames (driver and glyph warm-up) and
+    // frames that handled events, since SFML may allocate while queueing them
+    const int warmupFrames = 120;
+    int frameIndex = 0;
 
     sf::Clock moveClock;
     float acc = 0.f;
 
-    // Main loop
-    while (window.isOpen()) {
-        // --- Events ---
-        while (const auto event = window.pollEvent()) {
-            if (event->is<sf::Event::Closed>()) window.close();
-            if (const auto* keyPressed = event->getIf<sf::Event::KeyPressed>()) {
-                if (keyPressed->code == sf::Keyboard::Key::Escape) window.close();
-                if (keyPressed->code == sf::Keyboard::Key::P) paused = !paused;
-                if (keyPressed->code == sf::Keyboard::Key::R) {
-                    // restart
-                    snake = Snake(startPos, 5);
-                    placeFood();
-                    score = 0;
-                    paused = false;
-                    gameOver = false;
-                    moveClock.restart();
-                }
-                if (!gameOver) {
-                    if (keyPressed->code == sf::Keyboard::Key::Up || keyPressed->code == sf::Keyboard::Key::W) snake.setDirection({0, -1});
-                    if (keyPressed->code == sf::Keyboard::Key::Down || keyPressed->code == sf::Keyboard::Key::S) snake.setDirection({0, 1});
-                    if (keyPressed->code == sf::Keyboard::Key::Left || keyPressed->code == sf::Keyboard::Key::A) snake.setDirection({-1, 0});
-                    if (keyPressed->code == sf::Keyboard::Key::Right || keyPressed->code == sf::Keyboard::Key::D) snake.setDirection({1, 0});
-                }
+    // direction presses wait here and are applied one per tick
+    InputQueue inputs;
+    sf::Clock inputClock;
+
+    // F2 hands the steering to the pathfinding autopilot, or with --policy
+    // cycle to the Hamiltonian-cycle player
+    Autopilot pilot;
+    // its buffers take ~16 bytes a cell; huge worlds size them on first use
+    if ((size_t)cfg.cols * cfg.rows <= (size_t(1) << 20)) pilot.prepare(cfg.cols, cfg.rows);
+    CyclePlayer cyclePlayer;
+    const bool useCycle = headlessOpts.policy == Policy::Cycle && cyclePlayer.prepare(cfg.cols, cfg.rows);
+    bool autopilotOn = headlessOpts.policy != Policy::Greedy;
+
+    // anything but pointer motion may change what is on screen
+    bool needRedraw = true;
+
+    auto handleEvent = [&](const sf::Event& event) {
+        if (!event.is<sf::Event::MouseMoved>()) needRedraw = true;
+        if (recordPath) recorder.reserveAhead(); // grow here, never in a frame without events
+        if (event.is<sf::Event::Closed>()) window.close();
+        if (const auto* keyPressed = event.getIf<sf::Event::KeyPressed>()) {
+            if (keyPressed->code == sf::Keyboard::Key::Escape) window.close();
+            if (keyPressed->code == sf::Keyboard::Key::P) paused = !paused;
+            if (keyPressed->code == sf::Keyboard::Key::F2) {
+                autopilotOn = !autopilotOn;
+                pilot.clear();
+                cyclePlayer.clear();
+                inputs.clear();
+            }
+            if (keyPressed->code == sf::Keyboard::Key::F3) overlay.toggle();
+            if (keyPressed->code == sf::Keyboard::Key::R) {
+                // restart; a replay starts over from its first tick
+                if (playback) player.seek(game, 0);
+                else game.reset();
+                if (recordPath && !playback) recorder.restart();
+                inputs.clear();
+                pilot.clear();
+                cyclePlayer.clear();
+                paused = false;
+                entitiesDirty = true;
+                canvas.invalidate();
+                shaderBoard.invalidate();
+                moveClock.restart();
+            }
+            if (!game.gameOver && !paused && !playback && !autopilotOn) {
+                Action a = Action::None;
+                if (keyPressed->code == sf::Keyboard::Key::Up || keyPressed->code == sf::Keyboard::Key::W) a = Action::Up;
+                if (keyPressed->code == sf::Keyboard::Key::Down || keyPressed->code == sf::Keyboard::Key::S) a = Action::Down;
+                if (keyPressed->code == sf::Keyboard::Key::Left || keyPressed->code == sf::Keyboard::Key::A) a = Action::Left;
+                if (keyPressed->code == sf::Keyboard::Key::Right || keyPressed->code == sf::Keyboard::Key::D) a = Action::Right;
+                inputs.push(a, inputClock.getElapsedTime().asMicroseconds(), game.snake.dir, game.snake.body.size());
             }
         }
+    };
 
-        // --- Update ---
-        if (!paused && !gameOver) {
-            float dt = moveClock.restart().asSeconds();
-            acc += dt;
-            // handle movement at fixed interval
-            while (acc >= cfg.moveInterval) {
-                acc -= cfg.moveInterval;
-                snake.move();
+    // returns whether any event arrived
+    auto handleEvents = [&]() {
+        bool any = false;
+        while (const auto event = window.pollEvent()) {
+            any = true;
+            handleEvent(*event);
+        }
+        return any;
+    };
 
-                // boundary collision
-                Vec2i h = snake.head();
-                if (h.x < 0 || h.x >= cfg.cols || h.y < 0 || h.y >= cfg.rows) {
-                    gameOver = true;
+    // run the logic ticks that are due
+    auto runTicks = [&]() {
+        if (paused || game.gameOver) {
+            // if paused or gameOver, still reset the moveClock to avoid jump when unpausing
+            moveClock.restart();
+            return;
+        }
+        acc += moveClock.restart().asSeconds();
+        // handle movement at fixed interval
+        while (acc >= game.cfg.moveInterval) {
+            acc -= game.cfg.moveInterval;
+            if (playback) {
+                if (player.finished()) {
+                    paused = true;
+                    needRedraw = true;
                     break;
                 }
-                // self collision
-                if (snake.collidesWithSelf()) {
-                    gameOver = true;
-                    break;
+                timedStep([&] { return player.advance(game); });
+                canvas.note(game);
+                shaderBoard.note(game);
+                // recorded restarts happen straight away, not after a key press
+                if (game.gameOver) player.applyRestarts(game);
+            } else {
+                Action a = Action::None;
+                InputQueue::Entry press;
+                if (autopilotOn) {
+                    if (useCycle) a = cyclePlayer.decide(game);
+                    if (a == Action::None) a = pilot.decide(game);
                 }
-
-                // food?
-                if (snake.head() == food) {
-                    snake.grow();
-                    score += 10;
-                    placeFood();
-                    // optional speed up slightly every X points
-                    if (score % 50 == 0 && cfg.moveInterval > 0.04f) cfg.moveInterval *= 0.92f;
+                else if (inputs.pop(press)) {
+                    a = press.action;
+                    stats.inputLatencyMs = (float)(inputClock.getElapsedTime().asMicroseconds() - press.timeUs) / 1000.f;
                 }
+                const Vec2i before = game.snake.dir;
+                timedStep([&] { return game.step(a); });
+                if (recordPath) recorder.step(before, game.snake.dir);
+                canvas.note(game);
+                shaderBoard.note(game);
             }
-        } else {
-            // if paused or gameOver, still reset the moveClock to avoid jump when unpausing
-            moveClock.restart();
+            ++stats.ticks;
+            entitiesDirty = true;
+            needRedraw = true;
+            if (game.gameOver) break;
         }
+    };
 
-        // --- Render ---
-        window.clear(sf::Color(30, 30, 30));
-
-        // draw grid background (optional faint checker)
-        for (int x = 0; x < cfg.cols; ++x) {
-            for (int y = 0; y < cfg.rows; ++y) {
-                cellShape.setPosition(sf::Vector2f((float)x * cfg.cellSize, (float)y * cfg.cellSize));
-                if ((x + y) % 2 == 0) cellShape.setFillColor(sf::Color(38, 38, 38));
-                else cellShape.setFillColor(sf::Color(34, 34, 34));
-                window.draw(cellShape);
+    sf::Clock paceClock;
+
+    // Main loop
+    while (window.isOpen()) {
+        paceClock.restart();
+        SNAKE_ZONE("frame");
+        arena.reset();
+        const uint64_t allocsAtStart = allocationCount();
+        stats.ticks = 0;
+        bool hadEvents = false;
+
+        // --- Wait ---
+        // paused or game over: sleep in waitEvent() until a key arrives. On
+        // demand: sleep until the next tick or event. Either way nothing is
+        // drawn while the picture would not change.
+        const bool idle = paused || game.gameOver;
+        if ((idle || pacing == Pacing::OnDemand) && !needRedraw) {
+            sf::Time timeout = sf::Time::Zero; // no timeout
+            if (!idle) {
+                float untilTick = game.cfg.moveInterval - acc - moveClock.getElapsedTime().asSeconds();
+                timeout = sf::seconds(std::max(untilTick, 1e-6f));
             }
+            hadEvents |= sleepUntilEvent(window, timeout, handleEvent);
+            frameClock.restart(); // the graph shows frame work, not time spent asleep
         }
 
-        // draw food
-        sf::RectangleShape foodShape(sf::Vector2f((float)cfg.cellSize - 2.f, (float)cfg.cellSize - 2.f));
-        foodShape.setPosition(sf::Vector2f((float)food.x * cfg.cellSize + 1.f, (float)food.y * cfg.cellSize + 1.f));
-        foodShape.setFillColor(sf::Color(200, 40, 40));
-        window.draw(foodShape);
-
-        // draw snake
-        sf::RectangleShape segShape(sf::Vector2f((float)cfg.cellSize - 2.f, (float)cfg.cellSize - 2.f));
-        bool headDrawn = false;
-        for (size_t i = 0; i < snake.body.size(); ++i) {
-            Vec2i s = snake.body[i];
-            segShape.setPosition(sf::Vector2f((float)s.x * cfg.cellSize + 1.f, (float)s.y * cfg.cellSize + 1.f));
-            if (i == 0) {
-                segShape.setFillColor(sf::Color(120, 220, 120)); // head
-                window.draw(segShape);
-                headDrawn = true;
-            } else {
-                segShape.setFillColor(sf::Color(80, 180, 80));
-                window.draw(segShape);
-            }
+        // --- Events ---
+        {
+            SNAKE_ZONE("events");
+            hadEvents |= handleEvents();
         }
 
-        // text
-        scoreText.setString("Score: " + std::to_string(score));
-        window.draw(scoreText);
+        // --- Update ---
+        sectionClock.restart();
+        {
+            SNAKE_ZONE("update");
+            runTicks();
+        }
+        stats.updateMs = sectionClock.restart().asSeconds() * 1000.f;
 
-        if (paused) {
-            infoText.setString("[P] Resume  [R] Restart  [Esc] Quit  (Paused)");
-            window.draw(infoText);
-        } else if (gameOver) {
-            sf::Text goText(font);
-            goText.setCharacterSize(36);
-            goText.setString("Game Over");
-            goText.setPosition(sf::Vector2f(windowW / 2.f - goText.getGlobalBounds().size.x / 2.f, windowH / 2.f - 40.f));
-            window.draw(goText);
+        if (!needRedraw && (pacing == Pacing::OnDemand || paused || game.gameOver)) continue;
+        needRedraw = false;
 
-            infoText.setString("[R] Restart  [Esc] Quit");
-            window.draw(infoText);
+        // --- Render ---
+        int drawCalls = 0;
+        window.clear(palette::clear);
+
+        // the world is drawn through the camera, centred on the head; only
+        // head and tail are interpolated by the leftover fraction of the tick
+        // (not on demand, which only draws when a tick lands)
+        const bool snapped = game.gameOver || pacing == Pacing::OnDemand;
+        const float alpha = snapped ? 1.f : acc / game.cfg.moveInterval;
+        camera.setCenter(followCenter(game, alpha, camera.getSize()));
+        window.setView(camera);
+
+        if (useShader) {
+            // one quad for the board; two texels of its cell texture per tick
+            {
+                SNAKE_ZONE("background");
+                shaderBoard.sync(game);
+                drawCalls += shaderBoard.draw(window);
+            }
+            buildMovingEntities(entities, game);
+        } else if (useCanvas) {
+            // the board texture, with only the cells the last ticks changed
+            // redrawn, then the three quads that move every frame
+            {
+                SNAKE_ZONE("background");
+                drawCalls += canvas.sync(game);
+                drawCalls += canvas.draw(window);
+            }
+            buildMovingEntities(entities, game);
         } else {
-            infoText.setString("[Arrows / WASD] Move  [P] Pause  [R] Restart  [Esc] Quit");
-            window.draw(infoText);
+            // draw grid background (optional faint checker), rebuilt only on grid
+            // changes; only tiles in view are submitted
+            {
+                SNAKE_ZONE("background");
+                background.update(game.cfg);
+                drawCalls += background.draw(window);
+            }
+
+            // draw the visible food and snake in one batch
+            SNAKE_ZONE("food+snake");
+            const sf::IntRect cells = visibleCells(camera, game.cfg.cellSize, game.cfg.cols, game.cfg.rows);
+            if (entitiesDirty || cells != shownCells) {
+                buildVisibleEntities(entities, game, cells);
+                shownCells = cells;
+                entitiesDirty = false;
+            }
         }
+        {
+            SNAKE_ZONE("food+snake");
+            interpolateEntities(entities, game, alpha);
+            drawCalls += entities.draw(window);
+        }
+        window.setView(window.getDefaultView());
+
+        // text, rebuilt only when the score or state changes
+        HudMode mode = paused ? HudMode::Paused : !game.gameOver ? HudMode::Playing : game.won ? HudMode::Won : HudMode::GameOver;
+        {
+            SNAKE_ZONE("hud");
+            hud.update(game.score, mode);
+            drawCalls += hud.draw(window);
+            drawCalls += overlay.draw(window, arena);
+        }
+        stats.drawCalls = drawCalls;
+        stats.renderMs = sectionClock.restart().asSeconds() * 1000.f;
 
-        window.display();
+        {
+            SNAKE_ZONE("display");
+            window.display();
+        }
+        SNAKE_FRAME();
+
+        // wait out the frame, polling input and running ticks that fall due
+        if (selfPaced) {
+            SNAKE_ZONE("pace");
+            const sf::Time slice = sf::seconds(1.f / (float)inputHz);
+            for (sf::Time left = frameBudget - paceClock.getElapsedTime(); left > sf::Time::Zero && window.isOpen();
+                 left = frameBudget - paceClock.getElapsedTime()) {
+                sf::sleep(left < slice ? left : slice);
+                hadEvents |= handleEvents();
+                runTicks();
+            }
+        }
+        stats.frameMs = frameClock.restart().asSeconds() * 1000.f;
+        stats.allocs = allocationCount() - allocsAtStart;
+        overlay.record(stats);
+
+        ++frameIndex;
+        if (assertNoAlloc && allocationCountingEnabled && stats.allocs > 0 && !hadEvents && frameIndex > warmupFrames) {
+            std::fprintf(stderr, "steady frame %d made %llu heap allocations\n", frameIndex, (unsigned long long)stats.allocs);
+            std::abort();
+        }
     }
 
+    if (recordPath) {
+        const Replay& r = recorder.replay();
+        if (!r.save(recordPath)) {
+            std::cerr << "can't write replay " << recordPath << "\n";
+            return 1;
+        }
+        std::cout << "recorded " << r.ticks << " ticks to " << recordPath << "\n";
+    }
     return 0;
 }
\ No newline at end of file
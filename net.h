@@ -0,0 +1,718 @@
+// net.h
+// Authoritative UDP server hosting many single-player matches, and the thin
+// client side that mirrors one of them.
+//
+// The server steps each match's GameState at its own moveInterval and keeps
+// the last historySize ticks as one-byte records: the direction the head
+// moved, whether the tail stayed (growth), whether the food moved (followed
+// by its cell), game over and won. Each client acknowledges the last tick it
+// applied; the server sends it every record after that in one datagram, so a
+// lost packet is repaired by the next one and a playing client costs a few
+// bytes per tick. A client that is new, restarted or too far behind gets a
+// full state instead: the head plus the body as 2-bit steps (see snapshot.h),
+// the RNG and the speed, so the client can run GameState::step() itself.
+// Clients replay each record through step() and check the outcome against it;
+// a mismatch asks for a full state again.
+//
+// Presses are tagged with the tick they should apply on (see prediction.h)
+// and repeated until confirmed. The server applies a press on its tick, or on
+// the next tick it runs when it arrives late, and reports how far ahead of it
+// the client's ticks were, so the client can keep its lead.
+//
+// Datagrams start with a type byte; all numbers are Replay varints.
+//   client -> server
+//     Hello:   version
+//     Input:   match, round, acked tick, client tick, count, count (tick, action) oldest first
+//     Restart: match
+//     Bye:     match
+//   server -> client
+//     Full:    match, round, cols, rows, tick, score, food x, y, flags, dir,
+//              length, head x + 1, y + 1, prevTail x, y, moveInterval bits,
+//              RNG kind and state words, then the body steps
+//     Delta:   match, round, base tick, count, score, echoed client tick,
+//              zigzag lead, then count records
+//     Busy:    (no free match)
+// A round counts the match's restarts, since a restart sends tick back to 0.
+
+#pragma once
+
+#include <SFML/Network.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "game_state.h"
+#include "prediction.h"
+#include "replay.h"
+#include "snapshot.h"
+
+namespace net {
+
+constexpr unsigned short defaultPort = 52000;
+constexpr uint8_t version = 2;
+constexpr size_t historySize = 64; // ticks a client may fall behind before it gets a full state
+constexpr size_t inputResend = 4;  // unconfirmed presses repeated in every Input, covering for lost packets
+constexpr size_t pendingPresses = 8;
+
+// boards whose full state fits in one datagram, the only ones a server
+// serves; a client rejects any other size before it builds a game for it
+inline bool boardFits(int cols, int rows) {
+    return cols >= 2 && rows >= 2 && (size_t)cols * rows / 4 + 128 <= sf::UdpSocket::MaxDatagramSize;
+}
+
+enum class Msg : uint8_t { Hello = 1, Input, Restart, Bye, Full, Delta, Busy };
+
+// delta record flags; the low two bits are the head's direction as Action - 1
+constexpr uint8_t grewFlag = 4;
+constexpr uint8_t foodFlag = 8;
+constexpr uint8_t overFlag = 16;
+constexpr uint8_t wonFlag = 32;
+
+struct TickRecord {
+    uint8_t flags = 0;
+    Vec2i food;
+};
+
+// bounds-checked reading of a datagram
+class Reader {
+public:
+    Reader(const uint8_t* data, size_t size) : p(data), end(data + size) {}
+
+    bool byte(uint8_t& v) {
+        if (p == end) return false;
+        v = *p++;
+        return true;
+    }
+    bool varint(uint64_t& v) { return Replay::getVarint(p, end, v); }
+    template <class T>
+    bool number(T& v) {
+        uint64_t u;
+        if (!varint(u)) return false;
+        v = (T)u;
+        return true;
+    }
+    const uint8_t* rest() const { return p; }
+    size_t left() const { return (size_t)(end - p); }
+
+private:
+    const uint8_t* p;
+    const uint8_t* end;
+};
+
+inline void put(std::vector<uint8_t>& out, uint64_t v) { Replay::putVarint(out, v); }
+
+inline uint64_t zigzag(int64_t v) { return ((uint64_t)v << 1) ^ (uint64_t)(v >> 63); }
+inline int64_t unzigzag(uint64_t v) { return (int64_t)(v >> 1) ^ -(int64_t)(v & 1); }
+
+// the full state of a match, with snap as scratch
+inline void writeFull(std::vector<uint8_t>& out, uint32_t match, uint32_t round, const GameState& game, GameSnapshot& snap) {
+    saveSnapshot(game, snap);
+    const SnapshotHeader& h = snap.header;
+    out.push_back((uint8_t)Msg::Full);
+    for (uint64_t v : {(uint64_t)match, (uint64_t)round, (uint64_t)game.cfg.cols, (uint64_t)game.cfg.rows, h.tick,
+                       (uint64_t)h.score, (uint64_t)h.food.x, (uint64_t)h.food.y, (uint64_t)h.flags, (uint64_t)h.dir,
+                       (uint64_t)h.length, (uint64_t)(h.head.x + 1), (uint64_t)(h.head.y + 1), (uint64_t)h.prevTail.x,
+                       (uint64_t)h.prevTail.y})
+        put(out, v);
+    uint32_t interval;
+    std::memcpy(&interval, &h.moveInterval, sizeof interval);
+    put(out, interval);
+    out.push_back((uint8_t)h.rng.kind);
+    if (h.rng.kind == RngKind::Pcg32) {
+        put(out, h.rng.pcg.state);
+        put(out, h.rng.pcg.inc);
+    } else {
+        for (uint64_t w : h.rng.xo.s) put(out, w);
+    }
+    out.insert(out.end(), snap.path.begin(), snap.path.end());
+}
+
+// The server's state as last confirmed: a GameState loaded from Full and
+// stepped with the direction of each Delta record, so food placement and
+// speed-ups follow too. A record whose outcome doesn't match marks it out of
+// sync until the next full state.
+class Mirror {
+public:
+    explicit Mirror(const GameConfig& base) : cfg(base) {}
+
+    bool synced() const { return game.has_value(); }
+    bool outOfSync() const { return lost; }
+    const GameState& state() const { return *game; }
+    uint32_t match() const { return matchId; }
+    uint32_t roundNo() const { return round; }
+    uint64_t tick() const { return game ? game->tick : 0; }
+
+    // the server's view of the client's lead: how many ticks ahead of the
+    // server the client tick echoed() was when its Input arrived
+    uint64_t echoed() const { return echoTick; }
+    int64_t lead() const { return echoLead; }
+
+    enum class Update { None, Full, Ticks };
+
+    // apply one server datagram. onTick(state) runs after every confirmed
+    // tick a Delta brings; a Full reports Update::Full instead
+    template <class OnTick>
+    Update apply(const uint8_t* data, size_t size, OnTick onTick) {
+        Reader r(data, size);
+        uint8_t type;
+        if (!r.byte(type)) return Update::None;
+        if (type == (uint8_t)Msg::Full) return applyFull(r) ? Update::Full : Update::None;
+        if (type == (uint8_t)Msg::Delta) return applyDelta(r, onTick) ? Update::Ticks : Update::None;
+        return Update::None;
+    }
+
+private:
+    bool applyFull(Reader& r) {
+        uint32_t m, rd, interval;
+        int cols, rows;
+        SnapshotHeader h;
+        uint64_t hx, hy;
+        uint8_t kind;
+        if (!r.number(m) || !r.number(rd) || !r.number(cols) || !r.number(rows) || !r.varint(h.tick) ||
+            !r.number(h.score) || !r.number(h.food.x) || !r.number(h.food.y) || !r.number(h.flags) || !r.number(h.dir) ||
+            !r.number(h.length) || !r.varint(hx) || !r.varint(hy) || !r.number(h.prevTail.x) || !r.number(h.prevTail.y) ||
+            !r.number(interval) || !r.byte(kind) || kind > (uint8_t)RngKind::Xoshiro256)
+            return false;
+        h.rng.kind = (RngKind)kind;
+        bool ok = kind == (uint8_t)RngKind::Pcg32 ? r.varint(h.rng.pcg.state) && r.varint(h.rng.pcg.inc) : true;
+        for (int k = 0; ok && kind != (uint8_t)RngKind::Pcg32 && k < 4; ++k) ok = r.varint(h.rng.xo.s[k]);
+        if (!ok || !boardFits(cols, rows) || h.length == 0 || h.length > (uint32_t)cols * rows || h.dir > 3 ||
+            r.left() < ((size_t)h.length + 2) / 4 || (synced() && !lost && m == matchId && rd == round && h.tick <= tick()))
+            return false;
+        if (!game || game->cfg.cols != cols || game->cfg.rows != rows) {
+            GameConfig c = cfg;
+            c.cols = cols;
+            c.rows = rows;
+            game.emplace(c);
+        }
+        h.head = Vec2i((int)hx - 1, (int)hy - 1);
+        std::memcpy(&h.moveInterval, &interval, sizeof interval);
+        snap.header = h;
+        snap.path.assign(r.rest(), r.rest() + ((size_t)h.length + 2) / 4);
+        loadSnapshot(*game, snap);
+        matchId = m;
+        round = rd;
+        lost = false;
+        echoTick = 0; // client ticks start over with the round
+        echoLead = 0;
+        return true;
+    }
+
+    template <class OnTick>
+    bool applyDelta(Reader& r, OnTick onTick) {
+        uint32_t m, rd;
+        uint64_t base, echo, lead;
+        size_t count;
+        int score;
+        if (!game || lost || !r.number(m) || !r.number(rd) || !r.varint(base) || !r.number(count) || !r.number(score) ||
+            !r.varint(echo) || !r.varint(lead))
+            return false;
+        // another round, or a gap: wait for the full state the server sends next
+        if (m != matchId || rd != round || base > tick()) return false;
+        if (echo >= echoTick) {
+            echoTick = echo;
+            echoLead = unzigzag(lead);
+        }
+        bool changed = false;
+        for (uint64_t t = base + 1; t <= base + count; ++t) {
+            uint8_t flags;
+            Vec2i food = game->food;
+            if (!r.byte(flags) || ((flags & foodFlag) && (!r.number(food.x) || !r.number(food.y)))) return changed;
+            if (t <= tick()) continue; // already applied
+            const size_t length = game->snake.body.size();
+            game->step((Action)((flags & 3) + 1));
+            lost = game->tick != t || game->snake.dir != directionOf((Action)((flags & 3) + 1)) ||
+                   (game->snake.body.size() > length) != ((flags & grewFlag) != 0) || game->food != food ||
+                   game->gameOver != ((flags & overFlag) != 0) || game->won != ((flags & wonFlag) != 0);
+            if (lost) return changed;
+            onTick(*game);
+            changed = true;
+        }
+        if (changed && game->score != score) lost = true;
+        return changed;
+    }
+
+    GameConfig cfg;
+    std::optional<GameState> game;
+    GameSnapshot snap;
+    uint32_t matchId = 0;
+    uint32_t round = 0;
+    bool lost = false;
+    uint64_t echoTick = 0;
+    int64_t echoLead = 0;
+};
+
+struct ServerOptions {
+    unsigned short port = defaultPort;
+    size_t maxMatches = 256;
+    float timeoutSeconds = 10.f; // a match whose client goes quiet this long is closed
+    float reportSeconds = 10.f;  // period of the stats line, 0 = never
+};
+
+// All matches live in one process and one socket. Matches are allocated up
+// front and reused, so joining, playing and leaving don't touch the heap.
+class Server {
+public:
+    Server(const GameConfig& config, const ServerOptions& options) : cfg(config), opts(options) {
+        matches.reserve(opts.maxMatches);
+        for (size_t i = 0; i < opts.maxMatches; ++i) matches.emplace_back(cfg);
+        in.resize(2048);
+        out.reserve(sf::UdpSocket::MaxDatagramSize);
+    }
+
+    // boards whose full state doesn't fit in one datagram can't be served
+    static bool fits(const GameConfig& c) { return boardFits(c.cols, c.rows); }
+
+    // serve until the process is stopped; returns 1 when the port can't be bound
+    int run() {
+        if (socket.bind(opts.port) != sf::Socket::Status::Done) {
+            std::fprintf(stderr, "can't bind UDP port %u\n", (unsigned)opts.port);
+            return 1;
+        }
+        socket.setBlocking(false);
+        selector.add(socket);
+        std::printf("serving up to %zu matches on UDP port %u\n", matches.size(), (unsigned)opts.port);
+        double nextReport = opts.reportSeconds;
+        for (;;) {
+            // sleep until a datagram arrives or the next match is due
+            double now = clock.getElapsedTime().asSeconds();
+            double due = now + 0.1;
+            for (const Match& m : matches)
+                if (m.active) due = std::min(due, m.nextTickAt);
+            if (due > now) selector.wait(sf::seconds((float)(due - now)));
+            receiveAll();
+
+            now = clock.getElapsedTime().asSeconds();
+            for (size_t i = 0; i < matches.size(); ++i) {
+                Match& m = matches[i];
+                if (!m.active) continue;
+                if (now - m.lastHeard > opts.timeoutSeconds) {
+                    m.active = false;
+                    --activeCount;
+                    continue;
+                }
+                if (m.nextTickAt > now) continue;
+                // a stalled server catches up a few ticks, then drops the rest
+                for (int n = 0; n < 4 && m.nextTickAt <= now; ++n) {
+                    tick(m);
+                    m.nextTickAt += m.game.cfg.moveInterval;
+                }
+                if (m.nextTickAt <= now) m.nextTickAt = now + m.game.cfg.moveInterval;
+                sendState((uint32_t)i);
+            }
+
+            if (opts.reportSeconds > 0 && now >= nextReport) {
+                std::printf("%zu matches, %.0f datagrams/s and %.1f KB/s out, %.0f in\n", activeCount,
+                            (double)sentPackets / opts.reportSeconds, (double)sentBytes / 1024.0 / opts.reportSeconds,
+                            (double)receivedPackets / opts.reportSeconds);
+                std::fflush(stdout);
+                sentPackets = sentBytes = receivedPackets = 0;
+                nextReport = now + opts.reportSeconds;
+            }
+        }
+    }
+
+private:
+    struct Match {
+        explicit Match(const GameConfig& c) : game(c) {}
+
+        GameState game;
+        bool active = false;
+        uint32_t round = 0;
+        uint64_t ackTick = 0;
+        uint32_t ackRound = 0;
+        bool acked = false; // the client has confirmed some state of this round
+        Predictor::Press pending[pendingPresses]; // by tick, not applied yet
+        size_t pendingCount = 0;
+        uint64_t lastPressTick = 0; // newest press taken in, to skip repeats
+        uint64_t echoTick = 0;      // client tick of the newest Input
+        int64_t lead = 0;           // how far that was ahead of this match's tick
+        sf::IpAddress address = sf::IpAddress::Any;
+        unsigned short port = 0;
+        double lastHeard = 0;
+        double nextTickAt = 0;
+        TickRecord history[historySize]; // record of tick t at t % historySize
+    };
+
+    void tick(Match& m) {
+        GameState& g = m.game;
+        if (g.gameOver) return;
+        // the press for this tick, or one that arrived too late for its own
+        Action a = Action::None;
+        if (m.pendingCount > 0 && m.pending[0].tick <= g.tick + 1) {
+            a = m.pending[0].action;
+            std::copy(m.pending + 1, m.pending + m.pendingCount, m.pending);
+            --m.pendingCount;
+        }
+        const size_t lengthBefore = g.snake.body.size();
+        const Vec2i foodBefore = g.food;
+        g.step(a);
+        TickRecord& rec = m.history[g.tick % historySize];
+        rec.flags = (uint8_t)((int)actionFor(g.snake.dir) - 1);
+        if (g.snake.body.size() > lengthBefore) rec.flags |= grewFlag;
+        if (g.food != foodBefore) rec.flags |= foodFlag;
+        if (g.gameOver) rec.flags |= overFlag;
+        if (g.won) rec.flags |= wonFlag;
+        rec.food = g.food;
+    }
+
+    // whatever the client hasn't acknowledged yet: the missing ticks, or the
+    // full state when they are no longer in the history
+    void sendState(uint32_t id) {
+        Match& m = matches[id];
+        const GameState& g = m.game;
+        const bool current = m.acked && m.ackRound == m.round;
+        if (current && m.ackTick >= g.tick) return;
+        out.clear();
+        if (!current || g.tick - m.ackTick > historySize) {
+            writeFull(out, id, m.round, g, snap);
+        } else {
+            out.push_back((uint8_t)Msg::Delta);
+            for (uint64_t v : {(uint64_t)id, (uint64_t)m.round, m.ackTick, g.tick - m.ackTick, (uint64_t)g.score, m.echoTick,
+                               zigzag(m.lead)})
+                put(out, v);
+            for (uint64_t t = m.ackTick + 1; t <= g.tick; ++t) {
+                const TickRecord& rec = m.history[t % historySize];
+                out.push_back(rec.flags);
+                if (rec.flags & foodFlag) {
+                    put(out, (uint64_t)rec.food.x);
+                    put(out, (uint64_t)rec.food.y);
+                }
+            }
+        }
+        send(m.address, m.port);
+    }
+
+    void send(const sf::IpAddress& address, unsigned short port) {
+        if (socket.send(out.data(), out.size(), address, port) == sf::Socket::Status::Done) {
+            ++sentPackets;
+            sentBytes += out.size();
+        }
+    }
+
+    void receiveAll() {
+        std::size_t received = 0;
+        std::optional<sf::IpAddress> sender;
+        unsigned short port = 0;
+        while (socket.receive(in.data(), in.size(), received, sender, port) == sf::Socket::Status::Done) {
+            if (!sender) continue;
+            ++receivedPackets;
+            handle(Reader(in.data(), received), *sender, port);
+        }
+    }
+
+    // the client's match, or nullptr when the datagram isn't from its client
+    Match* owned(Reader& r, const sf::IpAddress& address, unsigned short port) {
+        uint32_t id;
+        if (!r.number(id) || id >= matches.size()) return nullptr;
+        Match& m = matches[id];
+        if (!m.active || !(m.address == address) || m.port != port) return nullptr;
+        m.lastHeard = clock.getElapsedTime().asSeconds();
+        return &m;
+    }
+
+    void handle(Reader r, const sf::IpAddress& address, unsigned short port) {
+        uint8_t type;
+        if (!r.byte(type)) return;
+        if (type == (uint8_t)Msg::Hello) {
+            uint8_t v;
+            if (r.byte(v) && v == version) join(address, port);
+            return;
+        }
+        Match* m = owned(r, address, port);
+        if (!m) return;
+        if (type == (uint8_t)Msg::Input) {
+            uint32_t round;
+            uint64_t ack, clientTick;
+            size_t count;
+            if (!r.number(round) || !r.varint(ack) || !r.varint(clientTick) || !r.number(count) || count > inputResend ||
+                round != m->round)
+                return;
+            if (ack <= m->game.tick && (!m->acked || m->ackRound != round || ack > m->ackTick)) {
+                m->acked = true;
+                m->ackRound = round;
+                m->ackTick = ack;
+            }
+            if (clientTick >= m->echoTick) {
+                m->echoTick = clientTick;
+                m->lead = (int64_t)clientTick - (int64_t)m->game.tick;
+            }
+            // presses arrive repeated; take in only the ones not seen yet
+            for (size_t k = 0; k < count; ++k) {
+                Predictor::Press p;
+                uint8_t a;
+                if (!r.varint(p.tick) || !r.byte(a) || a > (uint8_t)Action::Right) return;
+                if (p.tick <= m->lastPressTick || m->pendingCount == pendingPresses) continue;
+                p.action = (Action)a;
+                m->lastPressTick = p.tick;
+                m->pending[m->pendingCount++] = p;
+            }
+        } else if (type == (uint8_t)Msg::Restart) {
+            restart(*m);
+            sendState((uint32_t)(m - matches.data()));
+        } else if (type == (uint8_t)Msg::Bye) {
+            m->active = false;
+            --activeCount;
+        }
+    }
+
+    void join(const sf::IpAddress& address, unsigned short port) {
+        // a repeated Hello gets its match's state again
+        for (size_t i = 0; i < matches.size(); ++i) {
+            Match& m = matches[i];
+            if (m.active && m.address == address && m.port == port) {
+                m.acked = false;
+                sendState((uint32_t)i);
+                return;
+            }
+        }
+        for (size_t i = 0; i < matches.size(); ++i) {
+            Match& m = matches[i];
+            if (m.active) continue;
+            m.active = true;
+            ++activeCount;
+            m.address = address;
+            m.port = port;
+            m.round = 0;
+            m.lastHeard = clock.getElapsedTime().asSeconds();
+            // each game gets its own food sequence
+            m.game.cfg = cfg;
+            m.game.rng.seed(cfg.seed, cfg.rngKind, ++joins);
+            restart(m);
+            sendState((uint32_t)i);
+            return;
+        }
+        out.assign(1, (uint8_t)Msg::Busy);
+        send(address, port);
+    }
+
+    void restart(Match& m) {
+        m.game.cfg.moveInterval = cfg.moveInterval;
+        m.game.reset();
+        ++m.round;
+        m.acked = false;
+        m.pendingCount = 0;
+        m.lastPressTick = 0;
+        m.echoTick = 0;
+        m.lead = 0;
+        m.nextTickAt = clock.getElapsedTime().asSeconds() + m.game.cfg.moveInterval;
+    }
+
+    GameConfig cfg;
+    ServerOptions opts;
+    std::vector<Match> matches;
+    size_t activeCount = 0;
+    uint64_t joins = 0;
+    sf::UdpSocket socket;
+    sf::SocketSelector selector;
+    sf::Clock clock;
+    std::vector<uint8_t> in;
+    std::vector<uint8_t> out;
+    GameSnapshot snap;
+    uint64_t sentPackets = 0;
+    uint64_t sentBytes = 0;
+    uint64_t receivedPackets = 0;
+};
+
+// One client's connection: joins a match, keeps the confirmed Mirror of it
+// and, with prediction on, a Predictor running ahead of it that applies the
+// local presses at once. Without prediction a press is tagged for the next
+// confirmed tick, so it shows only after the round trip.
+class Client {
+public:
+    // ticks ahead of the server the client's Inputs should arrive
+    static constexpr int64_t minLead = 1;
+    static constexpr int64_t maxLead = 4;
+
+    explicit Client(const GameConfig& base, bool predict = true) : mirror(base), predictor(base), predicting(predict) {
+        in.resize(sf::UdpSocket::MaxDatagramSize);
+        out.reserve(64);
+    }
+
+    // host is a name or address, optionally with ":port"
+    bool connect(const std::string& host) {
+        std::string name = host;
+        serverPort = defaultPort;
+        size_t colon = host.rfind(':');
+        if (colon != std::string::npos) {
+            name = host.substr(0, colon);
+            serverPort = (unsigned short)std::atoi(host.c_str() + colon + 1);
+        }
+        std::optional<sf::IpAddress> resolved = sf::IpAddress::resolve(name);
+        if (!resolved) return false;
+        server = *resolved;
+        if (socket.bind(sf::Socket::AnyPort) != sf::Socket::Status::Done) return false;
+        socket.setBlocking(false);
+        hello();
+        return true;
+    }
+
+    bool ready() const { return mirror.synced(); }
+    bool busy() const { return rejected; }
+    const Mirror& confirmed() const { return mirror; }
+    const Predictor& prediction() const { return predictor; }
+
+    // what to draw: the prediction, or the confirmed state without one
+    const GameState& state() const { return predicting ? predictor.state() : mirror.state(); }
+
+    // take in what the server sent, run the predicted ticks that are due and
+    // send acknowledgements (also as keep-alives); true when state() changed
+    bool update() {
+        bool changed = false, heard = false;
+        std::size_t received = 0;
+        std::optional<sf::IpAddress> sender;
+        unsigned short port = 0;
+        while (socket.receive(in.data(), in.size(), received, sender, port) == sf::Socket::Status::Done) {
+            if (!sender || !(*sender == server) || port != serverPort || received == 0) continue;
+            heard = true;
+            if (in[0] == (uint8_t)Msg::Busy) rejected = true;
+            Mirror::Update u = mirror.apply(in.data(), received, [&](const GameState& g) {
+                if (predicting) predictor.confirm(g);
+                while (manualCount > 0 && manual[0].tick <= g.tick) {
+                    std::copy(manual + 1, manual + manualCount, manual);
+                    --manualCount;
+                }
+            });
+            if (u == Mirror::Update::Full) {
+                predictor.reset(mirror.state());
+                manualCount = 0;
+                adjustedAt = 0;
+                hold = 0;
+                acc = 0.f;
+                tickClock.restart();
+            }
+            changed |= u != Mirror::Update::None;
+        }
+        const float quiet = sinceSent.getElapsedTime().asSeconds();
+        if (!ready() || mirror.outOfSync()) {
+            // the Hello or its answer got lost, or we need a full state again
+            if ((heard || quiet > 0.5f) && !rejected) hello();
+            return changed;
+        }
+
+        if (predicting) {
+            const uint64_t before = predictor.rollbacks();
+            predictor.settle(mirror.state());
+            changed |= predictor.rollbacks() != before;
+            keepLead();
+            changed |= runDueTicks();
+        }
+        if (heard || quiet > 0.5f) sendInput();
+        return changed;
+    }
+
+    void press(Action a) {
+        if (a == Action::None || !ready()) return;
+        if (predicting) {
+            predictor.press(a); // sent once a predicted tick takes it
+            return;
+        }
+        if (manualCount == inputResend) return;
+        uint64_t t = std::max(mirror.tick(), manualCount > 0 ? manual[manualCount - 1].tick : 0) + 1;
+        manual[manualCount++] = {t, a};
+        sendInput();
+    }
+
+    void restart() {
+        if (!ready()) return;
+        out.clear();
+        out.push_back((uint8_t)Msg::Restart);
+        put(out, mirror.match());
+        send();
+    }
+
+    void leave() {
+        if (!ready()) return;
+        out.clear();
+        out.push_back((uint8_t)Msg::Bye);
+        put(out, mirror.match());
+        send();
+    }
+
+private:
+    // The server reports how far ahead our ticks were when an Input arrived.
+    // Too little and presses land late: jump ahead. Too much and every press
+    // waits: hold back a few ticks. Act again only on reports about Inputs
+    // sent after the last correction.
+    void keepLead() {
+        if (mirror.echoed() < adjustedAt || mirror.echoed() == 0) return;
+        const int64_t lead = mirror.lead();
+        if (lead < minLead) {
+            for (int64_t k = lead; k < minLead + 1 && predictor.advance(); ++k) {
+            }
+        } else if (lead > maxLead) {
+            hold = (int)(lead - (minLead + maxLead) / 2);
+        } else {
+            return;
+        }
+        adjustedAt = predictor.tick() + 1;
+    }
+
+    bool runDueTicks() {
+        bool ran = false;
+        acc += tickClock.restart().asSeconds();
+        const float interval = predictor.state().cfg.moveInterval;
+        while (acc >= interval) {
+            acc -= interval;
+            if (hold > 0) {
+                --hold;
+                continue;
+            }
+            if (!predictor.advance()) continue;
+            ran = true;
+            const size_t n = predictor.unconfirmed();
+            if (n > 0 && predictor.unconfirmedPress(n - 1).tick == predictor.tick()) sendInput(); // a press just applied
+        }
+        return ran;
+    }
+
+    void hello() {
+        out.assign({(uint8_t)Msg::Hello, version});
+        send();
+    }
+
+    // acknowledgement, our tick, and the oldest unconfirmed presses
+    void sendInput() {
+        const size_t count = std::min(predicting ? predictor.unconfirmed() : manualCount, inputResend);
+        out.clear();
+        out.push_back((uint8_t)Msg::Input);
+        for (uint64_t v : {(uint64_t)mirror.match(), (uint64_t)mirror.roundNo(), mirror.tick(),
+                           predicting ? predictor.tick() : mirror.tick(), (uint64_t)count})
+            put(out, v);
+        for (size_t k = 0; k < count; ++k) {
+            const Predictor::Press& p = predicting ? predictor.unconfirmedPress(k) : manual[k];
+            put(out, p.tick);
+            out.push_back((uint8_t)p.action);
+        }
+        send();
+    }
+
+    void send() {
+        (void)socket.send(out.data(), out.size(), server, serverPort);
+        sinceSent.restart();
+    }
+
+    Mirror mirror;
+    Predictor predictor;
+    bool predicting;
+    Predictor::Press manual[inputResend]; // without prediction: presses not confirmed yet
+    size_t manualCount = 0;
+    sf::Clock tickClock;
+    float acc = 0.f;
+    uint64_t adjustedAt = 0; // predicted tick of the last lead correction
+    int hold = 0;            // predicted ticks still to skip
+    sf::UdpSocket socket;
+    sf::IpAddress server = sf::IpAddress::LocalHost;
+    unsigned short serverPort = defaultPort;
+    std::vector<uint8_t> in;
+    std::vector<uint8_t> out;
+    sf::Clock sinceSent;
+    bool rejected = false;
+};
+
+} // namespace net
@@ -0,0 +1,137 @@
+// observation.h
+// Game states encoded for learning agents, written straight into a buffer
+// the caller owns: planeCount planes of rows x cols floats, row-major (body,
+// head, food, walls), then featureCount scalar features. The body plane is
+// expanded from the occupancy bitset four bits per SSE2 store (a scalar loop
+// elsewhere), so encoding costs the board's size in stores, never a walk of
+// the body; head and food are single writes into zeroed planes, and the wall
+// plane is copied from one built with the encoder. Nothing allocates per call.
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "batch_env.h"
+#include "game_state.h"
+#include "thread_pool.h"
+
+namespace obs {
+
+enum Plane { Body, Head, Food, Wall, planeCount };
+
+// distances are in cells over the board side along that axis
+enum Feature {
+    FoodDx, FoodDy,                       // food minus head
+    WallUp, WallDown, WallLeft, WallRight, // cells between the head and the edge
+    FreeUp, FreeDown, FreeLeft, FreeRight, // free cells before a segment or the edge
+    DirUp, DirDown, DirLeft, DirRight,     // heading, one-hot
+    Length,                                // body length over the board's cells
+    featureCount
+};
+
+// out[i] = bit i of bits as 1.0f or 0.0f, for i < n (n <= 64)
+inline void expandBits(uint64_t bits, int n, float* out) {
+    if (bits == 0) {
+        std::memset(out, 0, sizeof(float) * n); // most words on a big board
+        return;
+    }
+    int i = 0;
+#if defined(__SSE2__)
+    const __m128i select = _mm_setr_epi32(1, 2, 4, 8);
+    const __m128 one = _mm_set1_ps(1.f);
+    for (; i + 4 <= n; i += 4, bits >>= 4) {
+        const __m128i nibble = _mm_set1_epi32((int)(bits & 15));
+        const __m128i set = _mm_cmpeq_epi32(_mm_and_si128(nibble, select), select);
+        _mm_storeu_ps(out + i, _mm_and_ps(_mm_castsi128_ps(set), one));
+    }
+#endif
+    for (; i < n; ++i, bits >>= 1) out[i] = (float)(bits & 1);
+}
+
+// Encodes games on one board size into observations of size() floats.
+class Encoder {
+public:
+    Encoder(int cols, int rows) : cols(cols), rows(rows), walls((size_t)cols * rows, 0.f) {
+        for (int x = 0; x < cols; ++x) walls[x] = walls[(size_t)(rows - 1) * cols + x] = 1.f;
+        for (int y = 0; y < rows; ++y) walls[(size_t)y * cols] = walls[(size_t)y * cols + cols - 1] = 1.f;
+    }
+
+    size_t planeSize() const { return (size_t)cols * rows; }
+    size_t size() const { return planeCount * planeSize() + featureCount; }
+
+    // game's observation into out[0, size())
+    void encode(const GameState& game, float* out) const {
+        const OccupancyGrid& grid = game.snake.occupancy();
+        float* body = out + Body * planeSize();
+        for (int y = 0; y < rows; ++y) {
+            for (int cx = 0; cx < grid.chunkColumns(); ++cx) {
+                const int x = cx * OccupancyGrid::chunkSize;
+                expandBits(grid.rowBits(y, cx), std::min(OccupancyGrid::chunkSize, cols - x), body + (size_t)y * cols + x);
+            }
+        }
+        finish(out, game.snake.head(), game.snake.dir, game.food, game.snake.body.size(),
+               [&](Vec2i p) { return grid.count(p) > 0; });
+    }
+
+    // environment k of env into out[0, size()); the env's bitset is already
+    // in plane order, one word per 64 cells
+    void encode(const BatchEnv& env, size_t k, float* out) const {
+        const uint64_t* bits = env.occupancy(k);
+        float* body = out + Body * planeSize();
+        for (size_t w = 0; w * 64 < planeSize(); ++w) expandBits(bits[w], (int)std::min<size_t>(64, planeSize() - w * 64), body + w * 64);
+        finish(out, env.head(k), env.direction(k), env.foodCell(k), env.snakeLength(k), [&](Vec2i p) { return env.occupied(k, p); });
+    }
+
+    // every environment of env in one pass, k's observation at out + k * size(),
+    // spread across the pool when one is given
+    void encode(const BatchEnv& env, float* out, ThreadPool* pool = nullptr) const {
+        auto range = [&](size_t begin, size_t end) {
+            for (size_t k = begin; k < end; ++k) encode(env, k, out + k * size());
+        };
+        if (pool) pool->parallelFor(env.size(), range);
+        else range(0, env.size());
+    }
+
+private:
+    bool inBounds(Vec2i p) const { return p.x >= 0 && p.x < cols && p.y >= 0 && p.y < rows; }
+
+    // the planes and features that don't come from the bitset
+    template <class Occupied>
+    void finish(float* out, Vec2i head, Vec2i dir, Vec2i food, size_t length, Occupied occupied) const {
+        float* headPlane = out + Head * planeSize();
+        float* foodPlane = out + Food * planeSize();
+        std::memset(headPlane, 0, sizeof(float) * planeSize() * 2); // head and food planes are adjacent
+        if (inBounds(head)) headPlane[(size_t)head.y * cols + head.x] = 1.f;
+        if (inBounds(food)) foodPlane[(size_t)food.y * cols + food.x] = 1.f;
+        std::memcpy(out + Wall * planeSize(), walls.data(), sizeof(float) * planeSize());
+
+        float* f = out + planeCount * planeSize();
+        const float sx = 1.f / (float)cols, sy = 1.f / (float)rows;
+        f[FoodDx] = (float)(food.x - head.x) * sx;
+        f[FoodDy] = (float)(food.y - head.y) * sy;
+        f[WallUp] = (float)head.y * sy;
+        f[WallDown] = (float)(rows - 1 - head.y) * sy;
+        f[WallLeft] = (float)head.x * sx;
+        f[WallRight] = (float)(cols - 1 - head.x) * sx;
+        static const Vec2i rays[4] = {{0, -1}, {0, 1}, {-1, 0}, {1, 0}}; // Feature order
+        for (int i = 0; i < 4; ++i) {
+            int n = 0;
+            for (Vec2i p = head + rays[i]; inBounds(p) && !occupied(p); p += rays[i]) ++n;
+            f[FreeUp + i] = (float)n * (rays[i].x == 0 ? sy : sx);
+            f[DirUp + i] = dir == rays[i] ? 1.f : 0.f;
+        }
+        f[Length] = (float)length / (float)planeSize();
+    }
+
+    int cols;
+    int rows;
+    std::vector<float> walls; // the Wall plane, the same every time
+};
+
+} // namespace obs
@@ -0,0 +1,97 @@
+// perf_overlay.h
+// Debug overlay toggled with F3: frame, update and render time, draw calls,
+// logic ticks and heap allocations per frame, and a rolling frame-time graph.
+// Recording a frame is a few stores, so it stays on while the overlay is
+// hidden and the graph is already filled when it is opened. Text goes through
+// a glyph atlas, so showing the overlay does not allocate either.
+
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <algorithm>
+
+#include "alloc_counter.h"
+#include "frame_arena.h"
+#include "render.h"
+
+struct FrameStats {
+    float frameMs = 0.f;        // display to display
+    float updateMs = 0.f;       // fixed-step logic
+    float renderMs = 0.f;       // building and submitting draws, before display()
+    int drawCalls = 0;
+    int ticks = 0;              // logic ticks run by the accumulator this frame
+    uint64_t allocs = 0;        // operator new calls this frame (debug builds)
+    float inputLatencyMs = 0.f; // press to the tick that applied it, last one seen
+};
+
+class PerfOverlay {
+public:
+    static constexpr int historySize = 240; // frames in the graph
+    static constexpr float graphMaxMs = 33.3f;
+
+    explicit PerfOverlay(const sf::Font& font) : glyphs(font, 13) {
+        panel.reserve(historySize + 2);
+        text.reserve(160);
+    }
+
+    bool visible() const { return shown; }
+    void toggle() { shown = !shown; }
+
+    void record(const FrameStats& s) {
+        history[next] = s.frameMs;
+        next = (next + 1) % historySize;
+        last = s;
+        if (shown) {
+            // text changes at a readable rate, not every frame
+            sinceText += s.frameMs;
+            worstMs = std::max(worstMs, s.frameMs);
+        }
+    }
+
+    // returns the number of draw calls issued; scratch text lives in the arena
+    int draw(sf::RenderTarget& target, FrameArena& arena) {
+        if (!shown) return 0;
+        const float width = (float)historySize;
+        const float graphH = 60.f;
+        sf::Vector2f origin((float)target.getSize().x - width - 8.f, 8.f);
+
+        if (sinceText >= 250.f || textEmpty) {
+            const char* allocs = allocationCountingEnabled ? arena.format("%llu", (unsigned long long)last.allocs) : "n/a";
+            const char* str = arena.format(
+                "frame  %6.2f ms (worst %.2f)\nupdate %6.3f ms\nrender %6.3f ms\ninput  %6.2f ms\n"
+                "draws  %d   ticks %d   allocs %s",
+                last.frameMs, worstMs, last.updateMs, last.renderMs, last.inputLatencyMs, last.drawCalls, last.ticks, allocs);
+            text.clear();
+            glyphs.write(text, str, origin + sf::Vector2f(4.f, graphH + 4.f), sf::Color(230, 230, 230));
+            sinceText = 0.f;
+            worstMs = 0.f;
+            textEmpty = false;
+        }
+
+        // panel, 60 Hz reference line and one bar per frame, oldest on the left
+        panel.clear();
+        panel.add(origin, sf::Vector2f(width, graphH + 88.f), sf::Color(0, 0, 0, 170));
+        float refY = origin.y + graphH - graphH * (16.7f / graphMaxMs);
+        panel.add(sf::Vector2f(origin.x, refY), sf::Vector2f(width, 1.f), sf::Color(90, 90, 160));
+        for (int i = 0; i < historySize; ++i) {
+            float ms = history[(next + i) % historySize];
+            float h = std::min(ms / graphMaxMs, 1.f) * graphH;
+            sf::Color c = ms > 16.7f ? sf::Color(230, 80, 80) : sf::Color(120, 220, 120);
+            panel.add(sf::Vector2f(origin.x + (float)i, origin.y + graphH - h), sf::Vector2f(1.f, h), c);
+        }
+        int calls = panel.draw(target);
+        return calls + text.draw(target, sf::RenderStates(&glyphs.texture()));
+    }
+
+private:
+    bool shown = false;
+    float history[historySize] = {};
+    int next = 0;
+    FrameStats last;
+    float sinceText = 0.f;
+    float worstMs = 0.f;
+    bool textEmpty = true;
+    GlyphAtlas glyphs;
+    QuadBatch text;
+    QuadBatch panel;
+};
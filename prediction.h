@@ -0,0 +1,135 @@
+// prediction.h
+// Client-side prediction: the local player's presses are applied at once to
+// a copy of the game that runs ahead of the last state the server confirmed,
+// using the same deterministic GameState::step() (food included, the RNG is
+// part of the state). Each press is logged with the tick it was applied on,
+// and those ticks travel to the server, which applies the press on the same
+// tick when it arrives in time.
+// Every tick the predicted game keeps a small signature (head, tail, length,
+// food, direction, game over). When a confirmed tick's state doesn't match
+// the signature predicted for it, the prediction rolls back to the confirmed
+// state with a snapshot load and re-simulates the logged presses after it.
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+
+#include "game_state.h"
+#include "input_queue.h"
+#include "snapshot.h"
+
+class Predictor {
+public:
+    static constexpr size_t window = 64; // ticks the prediction may run ahead
+
+    struct Press {
+        uint64_t tick = 0; // the tick it applies on
+        Action action = Action::None;
+    };
+
+    explicit Predictor(const GameConfig& cfg) : predicted(cfg) {}
+
+    // start over from a confirmed state: a join, a restart or a resync
+    void reset(const GameState& confirmed) {
+        predicted = confirmed; // the board may have changed size
+        inputs.clear();
+        pressCount = 0;
+        firstPress = 0;
+        confirmedTick = confirmed.tick;
+        record();
+    }
+
+    const GameState& state() const { return predicted; }
+    uint64_t tick() const { return predicted.tick; }
+    uint64_t lead() const { return predicted.tick - confirmedTick; }
+    uint64_t rollbacks() const { return rollbackCount; }
+
+    // queue a local press; it lands on the next predicted tick with room
+    void press(Action a) { inputs.push(a, 0, predicted.snake.dir, predicted.snake.body.size()); }
+
+    // one predicted tick; false when the prediction can't go further ahead
+    bool advance() {
+        if (predicted.gameOver || lead() >= window - 1) return false;
+        InputQueue::Entry e;
+        Action a = Action::None;
+        if (inputs.pop(e)) {
+            a = e.action;
+            log[(firstPress + pressCount) % window] = {predicted.tick + 1, a};
+            if (pressCount == window) firstPress = (firstPress + 1) % window; // oldest is long confirmed
+            else ++pressCount;
+        }
+        predicted.step(a);
+        record();
+        return true;
+    }
+
+    // the logged presses the server hasn't confirmed yet, oldest first
+    size_t unconfirmed() const { return pressCount; }
+    const Press& unconfirmedPress(size_t k) const { return log[(firstPress + k) % window]; }
+
+    // the server confirmed a tick (call once per tick, in order); a state
+    // that differs from the prediction marks it for settle()
+    void confirm(const GameState& confirmed) {
+        confirmedTick = confirmed.tick;
+        while (pressCount > 0 && log[firstPress].tick <= confirmedTick) {
+            firstPress = (firstPress + 1) % window;
+            --pressCount;
+        }
+        if (confirmed.tick > predicted.tick) {
+            behind = true; // the prediction fell behind: just take the server's state
+            return;
+        }
+        if (!(signatures[confirmed.tick % window] == Signature::of(confirmed))) stale = true;
+    }
+
+    // after a batch of confirm()s: roll back and re-simulate if any missed
+    void settle(const GameState& confirmed) {
+        if (!stale && !behind) return;
+        if (stale && !behind) ++rollbackCount;
+        stale = behind = false;
+        const uint64_t target = std::max(predicted.tick, confirmed.tick);
+        copy(confirmed, predicted);
+        record();
+        size_t k = 0;
+        while (predicted.tick < target && !predicted.gameOver) {
+            Action a = Action::None;
+            if (k < pressCount && unconfirmedPress(k).tick == predicted.tick + 1) a = unconfirmedPress(k++).action;
+            predicted.step(a);
+            record();
+        }
+    }
+
+private:
+    struct Signature {
+        Vec2i head, tail, food, dir;
+        uint32_t length = 0;
+        bool over = false;
+
+        static Signature of(const GameState& g) {
+            return {g.snake.head(), g.snake.body.back(), g.food, g.snake.dir, (uint32_t)g.snake.body.size(), g.gameOver};
+        }
+        bool operator==(const Signature& o) const {
+            return head == o.head && tail == o.tail && food == o.food && dir == o.dir && length == o.length && over == o.over;
+        }
+    };
+
+    void record() { signatures[predicted.tick % window] = Signature::of(predicted); }
+
+    void copy(const GameState& from, GameState& to) {
+        saveSnapshot(from, scratch);
+        loadSnapshot(to, scratch);
+    }
+
+    GameState predicted;
+    GameSnapshot scratch;
+    InputQueue inputs; // pressed, not applied to a tick yet
+    Press log[window]; // applied, waiting for confirmation
+    size_t firstPress = 0;
+    size_t pressCount = 0;
+    Signature signatures[window];
+    uint64_t confirmedTick = 0;
+    uint64_t rollbackCount = 0;
+    bool stale = false;  // a confirmed tick missed its prediction
+    bool behind = false; // the server got ahead of the prediction
+};
@@ -0,0 +1,149 @@
+// profiler.h
+// Scoped profiling zones, compiled in only on request. SNAKE_ZONE("name")
+// times the rest of the enclosing block; SNAKE_FRAME() marks the end of a
+// frame. Without SNAKE_PROFILE or SNAKE_PROFILE_TRACY both expand to nothing
+// and this header costs nothing.
+//
+// SNAKE_PROFILE: each thread appends finished zones (name, start, duration)
+// to its own buffer, reserved on the thread's first zone so steady frames
+// stay free of allocations, and the process writes them as Chrome trace JSON
+// (chrome://tracing, Perfetto) at exit, to snake_trace.json or the path given
+// to profile::setOutput(). Zones past a thread's buffer are counted and dropped.
+// SNAKE_PROFILE_TRACY: the macros become Tracy's zones and frame marks.
+
+#pragma once
+
+#if defined(SNAKE_PROFILE_TRACY)
+
+#include <tracy/Tracy.hpp>
+
+#define SNAKE_ZONE(name) ZoneScopedN(name)
+#define SNAKE_FRAME() FrameMark
+
+namespace profile {
+inline void setOutput(const char*) {}
+} // namespace profile
+
+#elif defined(SNAKE_PROFILE)
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace profile {
+
+inline int64_t now() {
+    using namespace std::chrono;
+    return duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+// trace time zero, taken during static initialisation so it precedes every zone
+inline const int64_t origin = now();
+
+struct Zone {
+    const char* name; // a string literal
+    int64_t startNs;
+    int64_t durNs;
+};
+
+class Trace {
+public:
+    static constexpr size_t zonesPerThread = size_t(1) << 19;
+
+    static Trace& get() {
+        static Trace trace;
+        return trace;
+    }
+
+    void setOutput(const char* file) { path = file; }
+
+    void add(const Zone& z) {
+        thread_local Buffer* own = nullptr;
+        if (!own) own = attach();
+        if (own->zones.size() < zonesPerThread) own->zones.push_back(z);
+        else ++own->dropped;
+    }
+
+    ~Trace() { write(); }
+
+private:
+    struct Buffer {
+        uint32_t tid = 0;
+        std::vector<Zone> zones;
+        uint64_t dropped = 0;
+    };
+
+    Trace() = default;
+
+    Buffer* attach() {
+        std::lock_guard<std::mutex> lock(mutex);
+        buffers.push_back(std::make_unique<Buffer>());
+        Buffer* b = buffers.back().get();
+        b->tid = (uint32_t)buffers.size();
+        b->zones.reserve(zonesPerThread);
+        return b;
+    }
+
+    // every thread's zones as complete ("X") events, timestamps in microseconds
+    void write() {
+        std::lock_guard<std::mutex> lock(mutex);
+        FILE* f = std::fopen(path.c_str(), "w");
+        if (!f) {
+            std::fprintf(stderr, "profile: can't write %s\n", path.c_str());
+            return;
+        }
+        std::fputs("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n", f);
+        size_t count = 0;
+        uint64_t dropped = 0;
+        for (const auto& b : buffers) {
+            for (const Zone& z : b->zones)
+                std::fprintf(f, "%s{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}\n",
+                             count++ ? "," : "", z.name, b->tid, (double)(z.startNs - origin) / 1000.0, (double)z.durNs / 1000.0);
+            dropped += b->dropped;
+        }
+        std::fputs("]}\n", f);
+        std::fclose(f);
+        std::printf("profile: %zu zones to %s (%llu dropped)\n", count, path.c_str(), (unsigned long long)dropped);
+    }
+
+    std::mutex mutex;
+    std::vector<std::unique_ptr<Buffer>> buffers;
+    std::string path = "snake_trace.json";
+};
+
+class ScopedZone {
+public:
+    explicit ScopedZone(const char* name) : name(name), start(now()) {}
+    ~ScopedZone() { Trace::get().add({name, start, now() - start}); }
+
+    ScopedZone(const ScopedZone&) = delete;
+    ScopedZone& operator=(const ScopedZone&) = delete;
+
+private:
+    const char* name;
+    int64_t start;
+};
+
+inline void setOutput(const char* file) { Trace::get().setOutput(file); }
+
+} // namespace profile
+
+#define SNAKE_ZONE_JOIN2(a, b) a##b
+#define SNAKE_ZONE_JOIN(a, b) SNAKE_ZONE_JOIN2(a, b)
+#define SNAKE_ZONE(name) ::profile::ScopedZone SNAKE_ZONE_JOIN(snakeZone, __LINE__)(name)
+#define SNAKE_FRAME() ((void)0)
+
+#else
+
+#define SNAKE_ZONE(name) ((void)0)
+#define SNAKE_FRAME() ((void)0)
+
+namespace profile {
+inline void setOutput(const char*) {}
+} // namespace profile
+
+#endif
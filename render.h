@@ -0,0 +1,624 @@
+// render.h
+// Batched SFML drawing of the board: a cached background and one quad batch
+// for food and snake. Where shaders are available the board is drawn by one
+// (ShaderBoard); otherwise boards that fit in a texture are kept in one and
+// only patched where a tick changed them, and on worlds larger than that only
+// what the view can see is submitted, so frame cost follows the screen size.
+
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "arena.h"
+#include "game_state.h"
+
+namespace palette {
+const sf::Color clear(30, 30, 30);
+const sf::Color cellEven(38, 38, 38);
+const sf::Color cellOdd(34, 34, 34);
+const sf::Color food(200, 40, 40);
+const sf::Color head(120, 220, 120);
+const sf::Color body(80, 180, 80);
+
+// arena snake i's body colour: 0 keeps the single-player green, the rest are
+// spread around the hue wheel
+inline sf::Color snakeBody(size_t i) {
+    if (i == 0) return body;
+    const float h = std::fmod((float)i * 0.618034f, 1.f) * 6.f; // golden-ratio steps
+    const float x = 1.f - std::fabs(std::fmod(h, 2.f) - 1.f);
+    float r = 0, g = 0, b = 0;
+    switch ((int)h) {
+        case 0: r = 1, g = x; break;
+        case 1: r = x, g = 1; break;
+        case 2: g = 1, b = x; break;
+        case 3: g = x, b = 1; break;
+        case 4: r = x, b = 1; break;
+        default: r = 1, b = x; break;
+    }
+    auto channel = [](float v) { return (std::uint8_t)(60.f + v * 170.f); };
+    return sf::Color(channel(r), channel(g), channel(b));
+}
+
+// the same colour lightened for the head
+inline sf::Color snakeHead(size_t i) {
+    sf::Color c = snakeBody(i);
+    auto up = [](std::uint8_t v) { return (std::uint8_t)std::min(255, v + 40); };
+    return sf::Color(up(c.r), up(c.g), up(c.b));
+}
+} // namespace palette
+
+// cells overlapped by the view, clamped to the board
+inline sf::IntRect visibleCells(const sf::View& view, int cellSize, int cols, int rows) {
+    sf::Vector2f topLeft = view.getCenter() - view.getSize() / 2.f;
+    sf::Vector2f bottomRight = topLeft + view.getSize();
+    int x0 = std::max(0, (int)std::floor(topLeft.x / (float)cellSize));
+    int y0 = std::max(0, (int)std::floor(topLeft.y / (float)cellSize));
+    int x1 = std::min(cols, (int)std::ceil(bottomRight.x / (float)cellSize));
+    int y1 = std::min(rows, (int)std::ceil(bottomRight.y / (float)cellSize));
+    return sf::IntRect({x0, y0}, {std::max(0, x1 - x0), std::max(0, y1 - y0)});
+}
+
+// view centre that follows the head, alpha (0..1) of the way from its
+// previous cell, kept inside the world; an axis that fits in the view is
+// centred instead
+inline sf::Vector2f followCenter(const SnakeBody& body, const GameConfig& cfg, float alpha, sf::Vector2f viewSize) {
+    const float cs = (float)cfg.cellSize;
+    sf::Vector2f head((float)body[0].x, (float)body[0].y);
+    if (body.size() > 1) {
+        sf::Vector2f prev((float)body[1].x, (float)body[1].y);
+        head = prev + (head - prev) * std::min(std::max(alpha, 0.f), 1.f);
+    }
+    const sf::Vector2f world((float)cfg.cols * cs, (float)cfg.rows * cs);
+    auto axis = [](float at, float view, float size) {
+        if (size <= view) return size / 2.f;
+        return std::min(std::max(at, view / 2.f), size - view / 2.f);
+    };
+    return {axis((head.x + 0.5f) * cs, viewSize.x, world.x), axis((head.y + 0.5f) * cs, viewSize.y, world.y)};
+}
+
+inline sf::Vector2f followCenter(const GameState& game, float alpha, sf::Vector2f viewSize) {
+    return followCenter(game.snake.body, game.cfg, alpha, viewSize);
+}
+
+// Checkerboard background baked into tiles of tileCells x tileCells cells;
+// each visible tile is one draw call of the same vertex array, moved into
+// place by a transform. Tiles are rebuilt only when the grid dimensions
+// change, and a board that fits in one tile costs a single draw call.
+class GridBackground {
+public:
+    static constexpr int tileCells = 32; // even, so the checker lines up across tiles
+
+    void update(const GameConfig& cfg) {
+        if (cfg.cols == cols && cfg.rows == rows && cfg.cellSize == cellSize) return;
+        cols = cfg.cols;
+        rows = cfg.rows;
+        cellSize = cfg.cellSize;
+        // full tiles, plus the narrower / shorter ones along the right and bottom edges
+        const int w[2] = {std::min(tileCells, cols), cols % tileCells};
+        const int h[2] = {std::min(tileCells, rows), rows % tileCells};
+        for (int i = 0; i < 4; ++i) build(tiles[i], w[i & 1], h[i >> 1]);
+    }
+
+    // returns the number of draw calls issued
+    int draw(sf::RenderTarget& target) const {
+        sf::IntRect cells = visibleCells(target.getView(), cellSize, cols, rows);
+        if (cells.size.x <= 0 || cells.size.y <= 0) return 0;
+        int calls = 0;
+        const float tilePx = (float)(tileCells * cellSize);
+        for (int ty = cells.position.y / tileCells; ty * tileCells < cells.position.y + cells.size.y; ++ty) {
+            for (int tx = cells.position.x / tileCells; tx * tileCells < cells.position.x + cells.size.x; ++tx) {
+                int variant = (cols - tx * tileCells < tileCells ? 1 : 0) | (rows - ty * tileCells < tileCells ? 2 : 0);
+                sf::RenderStates states;
+                states.transform.translate(sf::Vector2f((float)tx * tilePx, (float)ty * tilePx));
+                target.draw(tiles[variant], states);
+                ++calls;
+            }
+        }
+        return calls;
+    }
+
+private:
+    void build(sf::VertexArray& vertices, int w, int h) const {
+        vertices.setPrimitiveType(sf::PrimitiveType::Triangles);
+        vertices.resize((size_t)w * h * 6);
+        const float size = (float)cellSize - 1.0f;
+        size_t v = 0;
+        for (int x = 0; x < w; ++x) {
+            for (int y = 0; y < h; ++y) {
+                sf::Color color = (x + y) % 2 == 0 ? palette::cellEven : palette::cellOdd;
+                sf::Vector2f tl((float)x * cellSize, (float)y * cellSize);
+                sf::Vector2f tr = tl + sf::Vector2f(size, 0.f);
+                sf::Vector2f bl = tl + sf::Vector2f(0.f, size);
+                sf::Vector2f br = tl + sf::Vector2f(size, size);
+                vertices[v++] = {tl, color};
+                vertices[v++] = {tr, color};
+                vertices[v++] = {bl, color};
+                vertices[v++] = {bl, color};
+                vertices[v++] = {tr, color};
+                vertices[v++] = {br, color};
+            }
+        }
+    }
+
+    sf::VertexArray tiles[4]; // bit 0: right-edge width, bit 1: bottom-edge height
+    int cols = 0;
+    int rows = 0;
+    int cellSize = 0;
+};
+
+// Batches solid-colour quads (snake segments, food, ...) into one vertex array
+// that is reused across frames, so a whole layer is submitted with one draw call.
+// The array only grows; clear() just rewinds the write cursor.
+class QuadBatch {
+public:
+    QuadBatch() : vertices(sf::PrimitiveType::Triangles) {}
+
+    void clear() { count = 0; }
+
+    // make room for n quads up front so filling the batch never allocates
+    void reserve(size_t n) {
+        if (n * 6 > vertices.getVertexCount()) vertices.resize(n * 6);
+    }
+
+    void add(sf::Vector2f pos, sf::Vector2f size, sf::Color color) { add(pos, size, {}, {}, color); }
+
+    // textured quad; uv is in texture pixels
+    void add(sf::Vector2f pos, sf::Vector2f size, sf::Vector2f uvPos, sf::Vector2f uvSize, sf::Color color) {
+        if ((count + 1) * 6 > vertices.getVertexCount())
+            vertices.resize(std::max<size_t>(64, vertices.getVertexCount() * 2));
+        write(count++, pos, size, uvPos, uvSize, color);
+    }
+
+    // rewrite quad i in place, e.g. to move one entity without refilling the batch
+    void set(size_t i, sf::Vector2f pos, sf::Vector2f size, sf::Color color) { write(i, pos, size, {}, {}, color); }
+
+    size_t size() const { return count; }
+
+    // returns the number of draw calls issued
+    int draw(sf::RenderTarget& target, const sf::RenderStates& states = sf::RenderStates::Default) const {
+        if (count == 0) return 0;
+        target.draw(&vertices[0], count * 6, sf::PrimitiveType::Triangles, states);
+        return 1;
+    }
+
+private:
+    void write(size_t i, sf::Vector2f pos, sf::Vector2f size, sf::Vector2f uvPos, sf::Vector2f uvSize, sf::Color color) {
+        sf::Vector2f tr = pos + sf::Vector2f(size.x, 0.f);
+        sf::Vector2f bl = pos + sf::Vector2f(0.f, size.y);
+        sf::Vector2f br = pos + size;
+        sf::Vector2f uvTr = uvPos + sf::Vector2f(uvSize.x, 0.f);
+        sf::Vector2f uvBl = uvPos + sf::Vector2f(0.f, uvSize.y);
+        sf::Vector2f uvBr = uvPos + uvSize;
+        size_t v = i * 6;
+        vertices[v++] = {pos, color, uvPos};
+        vertices[v++] = {tr, color, uvTr};
+        vertices[v++] = {bl, color, uvBl};
+        vertices[v++] = {bl, color, uvBl};
+        vertices[v++] = {tr, color, uvTr};
+        vertices[v++] = {br, color, uvBr};
+    }
+
+    sf::VertexArray vertices;
+    size_t count = 0;
+};
+
+// Glyphs of one font size rasterized once up front, so short strings (digits,
+// counters) can be written as textured quads into a QuadBatch without going
+// through sf::Text and its per-change geometry rebuild and allocations.
+class GlyphAtlas {
+public:
+    GlyphAtlas(const sf::Font& font, unsigned characterSize)
+        : font(&font), characterSize(characterSize), lineSpacing(font.getLineSpacing(characterSize)) {
+        for (int c = first; c <= last; ++c) {
+            const sf::Glyph& g = font.getGlyph((char32_t)c, characterSize, false);
+            glyphs[c - first] = {g.bounds, g.textureRect, g.advance};
+        }
+    }
+
+    // the font's page for this size; fetched per draw since the font may grow it
+    const sf::Texture& texture() const { return font->getTexture(characterSize); }
+    unsigned size() const { return characterSize; }
+
+    // append str with its top-left at pos (same placement as sf::Text); '\n'
+    // starts a new line. Returns the pen advance of the last line.
+    float write(QuadBatch& batch, const char* str, sf::Vector2f pos, sf::Color color) const {
+        float x = pos.x;
+        float baseline = pos.y + (float)characterSize;
+        for (; *str; ++str) {
+            int c = (unsigned char)*str;
+            if (c == '\n') {
+                x = pos.x;
+                baseline += lineSpacing;
+                continue;
+            }
+            if (c < first || c > last) continue;
+            const Entry& g = glyphs[c - first];
+            if (g.rect.size.x > 0 && g.rect.size.y > 0) {
+                batch.add(sf::Vector2f(x + g.bounds.position.x, baseline + g.bounds.position.y), g.bounds.size,
+                          sf::Vector2f(g.rect.position), sf::Vector2f(g.rect.size), color);
+            }
+            x += g.advance;
+        }
+        return x - pos.x;
+    }
+
+    float measure(const char* str) const {
+        float w = 0.f;
+        for (; *str; ++str) {
+            int c = (unsigned char)*str;
+            if (c >= first && c <= last) w += glyphs[c - first].advance;
+        }
+        return w;
+    }
+
+private:
+    static constexpr int first = 32; // printable ASCII
+    static constexpr int last = 126;
+
+    struct Entry {
+        sf::FloatRect bounds;
+        sf::IntRect rect;
+        float advance = 0.f;
+    };
+
+    const sf::Font* font;
+    unsigned characterSize;
+    float lineSpacing;
+    Entry glyphs[last - first + 1];
+};
+
+// Refill the batch with food and snake segments (head in its own colour).
+// Layout: quad 0 is the food, quad 1 the sliding tail (see
+// interpolateEntities()), then the body from its last cell to the head
+// (last), so the head is drawn on top.
+inline void buildEntities(QuadBatch& batch, const GameState& game) {
+    const int cs = game.cfg.cellSize;
+    const sf::Vector2f segSize((float)cs - 2.f, (float)cs - 2.f);
+    batch.clear();
+    batch.add(sf::Vector2f((float)game.food.x * cs + 1.f, (float)game.food.y * cs + 1.f), segSize, palette::food);
+    const SnakeBody& body = game.snake.body;
+    if (body.size() > 1) batch.add(sf::Vector2f((float)body.back().x * cs + 1.f, (float)body.back().y * cs + 1.f), segSize, palette::body);
+    for (size_t i = body.size(); i-- > 0;) {
+        Vec2i s = body[i];
+        batch.add(sf::Vector2f((float)s.x * cs + 1.f, (float)s.y * cs + 1.f), segSize, i == 0 ? palette::head : palette::body);
+    }
+}
+
+// The same layout with only what lies inside cells (see visibleCells()): the
+// food if visible, the sliding tail, the body segments (the last cell
+// included) found by scanning the visible cells' occupancy, and the head last. Cost follows the view, not the length
+// of the snake; the head and tail quads are always present for interpolation.
+inline void buildVisibleEntities(QuadBatch& batch, const GameState& game, const sf::IntRect& cells) {
+    const int cs = game.cfg.cellSize;
+    const sf::Vector2f segSize((float)cs - 2.f, (float)cs - 2.f);
+    auto at = [&](Vec2i p) { return sf::Vector2f((float)p.x * cs + 1.f, (float)p.y * cs + 1.f); };
+    const SnakeBody& body = game.snake.body;
+    const Vec2i head = body.front();
+    batch.clear();
+    // off-screen food still takes quad 0, sized to nothing
+    batch.add(at(game.food), cells.contains(game.food) ? segSize : sf::Vector2f(), palette::food);
+    if (body.size() > 1) batch.add(at(body.back()), segSize, palette::body);
+    const OccupancyGrid& grid = game.snake.occupancy();
+    for (int y = cells.position.y; y < cells.position.y + cells.size.y; ++y) {
+        for (int x = cells.position.x; x < cells.position.x + cells.size.x; ++x) {
+            Vec2i p(x, y);
+            if (grid.count(p) > 0 && p != head) batch.add(at(p), segSize, palette::body);
+        }
+    }
+    batch.add(at(head), segSize, palette::head);
+}
+
+// Only what moves every frame, in the same layout: food, sliding tail, head.
+// The rest of the snake, its last cell included, is baked into a BoardCanvas.
+inline void buildMovingEntities(QuadBatch& batch, const GameState& game) {
+    const int cs = game.cfg.cellSize;
+    const sf::Vector2f segSize((float)cs - 2.f, (float)cs - 2.f);
+    auto at = [&](Vec2i p) { return sf::Vector2f((float)p.x * cs + 1.f, (float)p.y * cs + 1.f); };
+    const SnakeBody& body = game.snake.body;
+    batch.clear();
+    batch.add(at(game.food), segSize, palette::food);
+    if (body.size() > 1) batch.add(at(body.back()), segSize, palette::body);
+    batch.add(at(body.front()), segSize, palette::head);
+}
+
+// Move the head and tail quads of a batch from buildEntities(),
+// buildVisibleEntities() or buildMovingEntities() to where they are a fraction alpha (0..1) of the way
+// through the last tick: the head
+// slides out of the previous head cell, the tail out of the cell it vacated
+// onto the last body cell, which is drawn as well, so no gap opens behind it.
+// Everything in between stays on its cell, so only two quads are rewritten.
+inline void interpolateEntities(QuadBatch& batch, const GameState& game, float alpha) {
+    const SnakeBody& body = game.snake.body;
+    if (body.size() < 2) return;
+    alpha = std::min(std::max(alpha, 0.f), 1.f);
+    const float cs = (float)game.cfg.cellSize;
+    const sf::Vector2f segSize(cs - 2.f, cs - 2.f);
+    auto lerpCell = [&](Vec2i from, Vec2i to) {
+        sf::Vector2f a((float)from.x, (float)from.y), b((float)to.x, (float)to.y);
+        sf::Vector2f p = a + (b - a) * alpha;
+        return sf::Vector2f(p.x * cs + 1.f, p.y * cs + 1.f);
+    };
+    batch.set(1, lerpCell(game.snake.prevTail, body.back()), segSize, palette::body);
+    batch.set(batch.size() - 1, lerpCell(body[1], body[0]), segSize, palette::head);
+}
+
+// The board kept in a persistent render texture: background plus the snake's
+// segments, everything but food and head (see buildMovingEntities()). A tick
+// changes only two of its cells, the old head that became body and the cell
+// the tail vacated, so note() after
+// each GameState::step() records them and sync() repaints just those with one
+// small draw into the texture; the window then shows it with a single sprite.
+// Restarts, seeks and anything else that replaces the board go through
+// invalidate() (a jump in the tick count is caught too) and cost one full
+// redraw, as does a change of board or cell size in prepare().
+class BoardCanvas {
+public:
+    static constexpr unsigned maxSide = 4096; // larger boards use the culled batches instead
+    static constexpr size_t maxDirty = 4096;  // past this many cells a full redraw is cheaper
+
+    // size the texture for cfg's board; false when it doesn't fit in one
+    bool prepare(const GameConfig& cfg) {
+        if (cfg.cols == cols && cfg.rows == rows && cfg.cellSize == cellSize) return ready;
+        cols = cfg.cols;
+        rows = cfg.rows;
+        cellSize = cfg.cellSize;
+        const unsigned w = (unsigned)(cols * cellSize), h = (unsigned)(rows * cellSize);
+        const unsigned limit = std::min(sf::Texture::getMaximumSize(), maxSide);
+        ready = w <= limit && h <= limit && texture.resize(sf::Vector2u(w, h));
+        background.update(cfg);
+        dirty.reserve(maxDirty);
+        patch.reserve(maxDirty * 3);
+        full = true;
+        return ready;
+    }
+
+    void invalidate() { full = true; }
+
+    // call after every step(); catches up on nothing, just remembers cells
+    void note(const GameState& game) {
+        if (full) return;
+        if (game.tick != notedTick + 1 || dirty.size() + 2 > maxDirty) {
+            full = true;
+            return;
+        }
+        notedTick = game.tick;
+        const SnakeBody& body = game.snake.body;
+        if (body.size() > 1) dirty.push_back(body[1]);
+        dirty.push_back(game.snake.prevTail);
+    }
+
+    // bring the texture up to date with game; returns the draw calls issued
+    int sync(const GameState& game) {
+        if (!ready) return 0;
+        if (full || game.tick != notedTick) return redraw(game);
+        if (dirty.empty()) return 0;
+        patch.clear();
+        for (Vec2i p : dirty) paint(game, p);
+        dirty.clear();
+        int calls = patch.draw(texture);
+        texture.display();
+        return calls;
+    }
+
+    // the board at its place in the world, through target's current view
+    int draw(sf::RenderTarget& target) const {
+        if (!ready) return 0;
+        target.draw(sf::Sprite(texture.getTexture()));
+        return 1;
+    }
+
+private:
+    bool inner(const GameState& game, Vec2i p) const {
+        const Snake& snake = game.snake;
+        return snake.occupancy().count(p) > 0 && p != snake.head();
+    }
+
+    void addSegment(Vec2i p) {
+        const float cs = (float)cellSize;
+        patch.add(sf::Vector2f((float)p.x * cs + 1.f, (float)p.y * cs + 1.f), sf::Vector2f(cs - 2.f, cs - 2.f), palette::body);
+    }
+
+    // the whole cell from scratch: gap colour, checker square, maybe a segment
+    void paint(const GameState& game, Vec2i p) {
+        if (!game.snake.occupancy().inBounds(p)) return; // a head that hit the wall
+        const float cs = (float)cellSize;
+        const sf::Vector2f at((float)p.x * cs, (float)p.y * cs);
+        patch.add(at, sf::Vector2f(cs, cs), palette::clear);
+        patch.add(at, sf::Vector2f(cs - 1.f, cs - 1.f), (p.x + p.y) % 2 == 0 ? palette::cellEven : palette::cellOdd);
+        if (inner(game, p)) addSegment(p);
+    }
+
+    int redraw(const GameState& game) {
+        texture.clear(palette::clear);
+        int calls = background.draw(texture);
+        patch.clear();
+        const SnakeBody& body = game.snake.body;
+        for (size_t i = 1; i < body.size(); ++i) addSegment(body[i]);
+        calls += patch.draw(texture);
+        texture.display();
+        dirty.clear();
+        full = false;
+        notedTick = game.tick;
+        return calls;
+    }
+
+    sf::RenderTexture texture;
+    GridBackground background;
+    QuadBatch patch; // quads drawn into the texture by the current sync()
+    std::vector<Vec2i> dirty;
+    uint64_t notedTick = 0;
+    bool full = true;
+    bool ready = false;
+    int cols = 0;
+    int rows = 0;
+    int cellSize = 0;
+};
+
+// The board drawn by a fragment shader: the checkerboard comes from the
+// fragment's world position and the cell size, and the body segments from a
+// texture with one texel per cell. The CPU submits one quad covering the view
+// whatever the board or snake size, and a tick uploads just the two texels
+// that changed (the same cells BoardCanvas repaints); food, head and the
+// sliding tail are still drawn on top by buildMovingEntities(). prepare() is false without
+// shader support or on boards past the cell texture's limits, which then
+// take one of the other paths.
+class ShaderBoard {
+public:
+    static constexpr unsigned maxSide = 4096; // cells per side: the texture costs 4 bytes per cell
+    static constexpr size_t maxDirty = 4096;
+
+    bool prepare(const GameConfig& cfg) {
+        if (cfg.cols == cols && cfg.rows == rows && cfg.cellSize == cellSize) return ready;
+        cols = cfg.cols;
+        rows = cfg.rows;
+        cellSize = cfg.cellSize;
+        const unsigned limit = std::min(sf::Texture::getMaximumSize(), maxSide);
+        ready = false;
+        if (!sf::Shader::isAvailable() || (unsigned)cols > limit || (unsigned)rows > limit) return false;
+        if (!compiled && !(compiled = shader.loadFromMemory(fragmentSource, sf::Shader::Type::Fragment))) return false;
+        if (!cells.resize(sf::Vector2u((unsigned)cols, (unsigned)rows))) return false;
+        shader.setUniform("cells", cells);
+        shader.setUniform("board", sf::Glsl::Vec2((float)cols, (float)rows));
+        shader.setUniform("cellSize", (float)cellSize);
+        shader.setUniform("gap", sf::Glsl::Vec4(palette::clear));
+        shader.setUniform("even", sf::Glsl::Vec4(palette::cellEven));
+        shader.setUniform("odd", sf::Glsl::Vec4(palette::cellOdd));
+        shader.setUniform("body", sf::Glsl::Vec4(palette::body));
+        dirty.reserve(maxDirty);
+        pixels.resize((size_t)cols * rows * 4);
+        full = true;
+        ready = true;
+        return true;
+    }
+
+    void invalidate() { full = true; }
+
+    // as BoardCanvas::note(): remembers the cells a step() changed
+    void note(const GameState& game) {
+        if (full) return;
+        if (game.tick != notedTick + 1 || dirty.size() + 2 > maxDirty) {
+            full = true;
+            return;
+        }
+        notedTick = game.tick;
+        const SnakeBody& body = game.snake.body;
+        if (body.size() > 1) dirty.push_back(body[1]);
+        dirty.push_back(game.snake.prevTail);
+    }
+
+    // bring the cell texture up to date with game; returns the texels uploaded
+    size_t sync(const GameState& game) {
+        if (!ready) return 0;
+        if (full || game.tick != notedTick) return upload(game);
+        const size_t n = dirty.size();
+        for (Vec2i p : dirty) {
+            if (!game.snake.occupancy().inBounds(p)) continue;
+            const uint8_t texel[4] = {inner(game, p) ? (uint8_t)255 : (uint8_t)0, 0, 0, 255};
+            cells.update(texel, sf::Vector2u(1, 1), sf::Vector2u((unsigned)p.x, (unsigned)p.y));
+        }
+        dirty.clear();
+        return n;
+    }
+
+    // the part of the board in target's view, as one quad
+    int draw(sf::RenderTarget& target) const {
+        if (!ready) return 0;
+        const sf::View& view = target.getView();
+        const sf::Vector2f half = view.getSize() / 2.f;
+        const float left = std::max(0.f, view.getCenter().x - half.x);
+        const float top = std::max(0.f, view.getCenter().y - half.y);
+        const float right = std::min((float)(cols * cellSize), view.getCenter().x + half.x);
+        const float bottom = std::min((float)(rows * cellSize), view.getCenter().y + half.y);
+        if (right <= left || bottom <= top) return 0;
+        // no texture bound, so texture coordinates reach the shader as world pixels
+        const sf::Vector2f corners[6] = {{left, top}, {right, top}, {left, bottom}, {left, bottom}, {right, top}, {right, bottom}};
+        sf::Vertex quad[6];
+        for (int i = 0; i < 6; ++i) quad[i] = sf::Vertex{corners[i], sf::Color::White, corners[i]};
+        sf::RenderStates states;
+        states.shader = &shader;
+        target.draw(quad, 6, sf::PrimitiveType::Triangles, states);
+        return 1;
+    }
+
+private:
+    // GridBackground's squares (cellSize - 1 on the gap colour) and
+    // BoardCanvas's segments (inset by a pixel), per fragment
+    static constexpr const char* fragmentSource = R"(
+uniform sampler2D cells;
+uniform vec2 board;
+uniform float cellSize;
+uniform vec4 gap;
+uniform vec4 even;
+uniform vec4 odd;
+uniform vec4 body;
+
+void main() {
+    vec2 world = gl_TexCoord[0].xy;
+    vec2 cell = floor(world / cellSize);
+    vec2 at = world - cell * cellSize;
+    vec4 color = gap;
+    if (at.x < cellSize - 1.0 && at.y < cellSize - 1.0)
+        color = mod(cell.x + cell.y, 2.0) < 0.5 ? even : odd;
+    if (at.x >= 1.0 && at.y >= 1.0 && at.x < cellSize - 1.0 && at.y < cellSize - 1.0 &&
+        texture2D(cells, (cell + 0.5) / board).r > 0.5)
+        color = body;
+    gl_FragColor = color;
+}
+)";
+
+    bool inner(const GameState& game, Vec2i p) const {
+        const Snake& snake = game.snake;
+        return snake.occupancy().count(p) > 0 && p != snake.head();
+    }
+
+    // every texel from the body; the cost of a restart or a seek
+    size_t upload(const GameState& game) {
+        for (size_t i = 0; i < pixels.size(); i += 4) {
+            pixels[i] = pixels[i + 1] = pixels[i + 2] = 0;
+            pixels[i + 3] = 255;
+        }
+        const SnakeBody& body = game.snake.body;
+        for (size_t i = 1; i < body.size(); ++i) pixels[((size_t)body[i].y * cols + body[i].x) * 4] = 255;
+        cells.update(pixels.data());
+        dirty.clear();
+        full = false;
+        notedTick = game.tick;
+        return (size_t)cols * rows;
+    }
+
+    sf::Shader shader;
+    sf::Texture cells;
+    std::vector<uint8_t> pixels; // staging for full uploads, sized by prepare()
+    std::vector<Vec2i> dirty;
+    uint64_t notedTick = 0;
+    bool compiled = false;
+    bool full = true;
+    bool ready = false;
+    int cols = 0;
+    int rows = 0;
+    int cellSize = 0;
+};
+
+// An arena's visible cells in one batch: body segments coloured by the owner
+// grid, food, then the heads on top. Everything is on its cell (arenas aren't
+// interpolated), and cost follows the view plus one check per snake.
+inline void buildArenaEntities(QuadBatch& batch, const ArenaState& arena, const sf::IntRect& cells) {
+    const int cs = arena.cfg.cellSize;
+    const sf::Vector2f segSize((float)cs - 2.f, (float)cs - 2.f);
+    auto at = [&](Vec2i p) { return sf::Vector2f((float)p.x * cs + 1.f, (float)p.y * cs + 1.f); };
+    batch.clear();
+    for (int y = cells.position.y; y < cells.position.y + cells.size.y; ++y) {
+        for (int x = cells.position.x; x < cells.position.x + cells.size.x; ++x) {
+            Vec2i p(x, y);
+            if (uint16_t o = arena.ownerAt(p)) batch.add(at(p), segSize, palette::snakeBody(o - 1u));
+            else if (arena.hasFood(p)) batch.add(at(p), segSize, palette::food);
+        }
+    }
+    for (size_t i = 0; i < arena.snakes.size(); ++i) {
+        const ArenaSnake& s = arena.snakes[i];
+        if (s.alive && cells.contains(s.body.front())) batch.add(at(s.body.front()), segSize, palette::snakeHead(i));
+    }
+}
@@ -0,0 +1,226 @@
+// replay.h
+// A session recorded as its seed plus the inputs that mattered: each tick that
+// got a direction press, and each restart. Everything else follows from
+// GameState being deterministic, so a full match is a few hundred bytes.
+//
+// File layout: "SNKR", version byte, RngKind byte, then varints for seed,
+// cols, rows and the session length in ticks, then one varint per event,
+// (ticks since the previous event << 3) | code, where code 0..3 is the
+// direction (Action - 1) applied on that tick and 4 a restart before it.
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+#include "game_state.h"
+
+struct Replay {
+    uint64_t seed = 0;
+    RngKind rngKind = RngKind::Pcg32;
+    int cols = 0;
+    int rows = 0;
+    uint64_t ticks = 0;         // logic ticks in the whole session
+    std::vector<uint8_t> events; // encoded event stream
+
+    static constexpr uint8_t version = 1;
+    static constexpr uint64_t restartCode = 4;
+
+    static void putVarint(std::vector<uint8_t>& out, uint64_t v) {
+        while (v >= 0x80) {
+            out.push_back((uint8_t)(v | 0x80));
+            v >>= 7;
+        }
+        out.push_back((uint8_t)v);
+    }
+
+    // false on truncated or overlong input
+    static bool getVarint(const uint8_t*& p, const uint8_t* end, uint64_t& v) {
+        v = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            if (p == end) return false;
+            uint8_t b = *p++;
+            v |= (uint64_t)(b & 0x7f) << shift;
+            if (!(b & 0x80)) return true;
+        }
+        return false;
+    }
+
+    bool save(const char* path) const {
+        std::vector<uint8_t> out = {'S', 'N', 'K', 'R', version, (uint8_t)rngKind};
+        putVarint(out, seed);
+        putVarint(out, (uint64_t)cols);
+        putVarint(out, (uint64_t)rows);
+        putVarint(out, ticks);
+        out.insert(out.end(), events.begin(), events.end());
+        FILE* f = std::fopen(path, "wb");
+        if (!f) return false;
+        bool ok = std::fwrite(out.data(), 1, out.size(), f) == out.size();
+        return std::fclose(f) == 0 && ok;
+    }
+
+    bool load(const char* path) {
+        FILE* f = std::fopen(path, "rb");
+        if (!f) return false;
+        std::vector<uint8_t> in;
+        uint8_t buf[4096];
+        size_t n;
+        while ((n = std::fread(buf, 1, sizeof buf, f)) > 0) in.insert(in.end(), buf, buf + n);
+        std::fclose(f);
+
+        if (in.size() < 6 || in[0] != 'S' || in[1] != 'N' || in[2] != 'K' || in[3] != 'R' || in[4] != version ||
+            in[5] > (uint8_t)RngKind::Xoshiro256)
+            return false;
+        const uint8_t* p = in.data() + 6;
+        const uint8_t* end = in.data() + in.size();
+        uint64_t c, r;
+        if (!getVarint(p, end, seed) || !getVarint(p, end, c) || !getVarint(p, end, r) || !getVarint(p, end, ticks))
+            return false;
+        if (c == 0 || r == 0 || c > 65535 || r > 65535) return false;
+        rngKind = (RngKind)in[5];
+        cols = (int)c;
+        rows = (int)r;
+        events.assign(p, end);
+        return true;
+    }
+};
+
+// Appends to a Replay as the game runs. Call step() after every
+// GameState::step() with the snake's direction before and after it, and
+// restart() with every GameState::reset(). Only real turns are stored, so
+// presses the game ignored (same direction, reversals) cost nothing.
+class ReplayRecorder {
+public:
+    // reserve up front so a long session doesn't allocate mid-game (see reserveAhead())
+    void begin(const GameConfig& cfg, size_t reserveBytes = 64 * 1024) {
+        data = Replay();
+        data.seed = cfg.seed;
+        data.rngKind = cfg.rngKind;
+        data.cols = cfg.cols;
+        data.rows = cfg.rows;
+        data.events.reserve(reserveBytes);
+        lastEvent = 0;
+    }
+
+    void step(Vec2i dirBefore, Vec2i dirAfter) {
+        if (dirAfter != dirBefore) put((uint64_t)actionFor(dirAfter) - 1);
+        ++data.ticks;
+    }
+
+    void restart() { put(Replay::restartCode); }
+
+    // double the reservation when less than slack bytes are left. The window
+    // calls this on frames that handle events, which may allocate anyway, so
+    // a player's turns never grow it mid-frame; autopilot turns come without
+    // events, so a long unattended round can still outgrow it inside a frame
+    void reserveAhead(size_t slack = 16 * 1024) {
+        if (data.events.capacity() - data.events.size() < slack)
+            data.events.reserve(std::max(data.events.capacity() * 2, data.events.size() + slack));
+    }
+
+    const Replay& replay() const { return data; }
+
+private:
+    void put(uint64_t code) {
+        Replay::putVarint(data.events, (data.ticks - lastEvent) << 3 | code);
+        lastEvent = data.ticks;
+    }
+
+    Replay data;
+    uint64_t lastEvent = 0;
+};
+
+// Drives a GameState from a Replay, one logic tick at a time.
+class ReplayPlayer {
+public:
+    // base supplies what the file doesn't store (cell size, starting speed)
+    explicit ReplayPlayer(const Replay& r, const GameConfig& base = GameConfig()) : rep(&r), start(configFor(r, base)) {
+        rewind();
+    }
+
+    // the config a recorded session ran with
+    static GameConfig configFor(const Replay& r, GameConfig cfg = GameConfig()) {
+        cfg.seed = r.seed;
+        cfg.rngKind = r.rngKind;
+        cfg.cols = r.cols;
+        cfg.rows = r.rows;
+        return cfg;
+    }
+
+    void rewind() {
+        p = rep->events.data();
+        end = p + rep->events.size();
+        tick = 0;
+        corrupt = false;
+        decode();
+    }
+
+    const GameConfig& config() const { return start; }
+    uint64_t position() const { return tick; }
+    bool finished() const { return tick >= rep->ticks; }
+    bool corrupted() const { return corrupt; }
+
+    // apply restarts recorded before the next tick; playback calls this while
+    // the game is over, where no ticks run
+    void applyRestarts(GameState& game) {
+        while (pending && nextTick == tick && nextCode == Replay::restartCode) {
+            game.reset();
+            decode();
+        }
+    }
+
+    // one recorded tick
+    StepResult advance(GameState& game) {
+        applyRestarts(game);
+        Action a = Action::None;
+        if (pending && nextTick == tick && nextCode < 4) {
+            a = (Action)(nextCode + 1);
+            decode();
+        }
+        ++tick;
+        return game.step(a);
+    }
+
+    // run headless up to tick target (or the end); returns the ticks run
+    uint64_t seek(GameState& game, uint64_t target) {
+        if (target < tick) {
+            game = GameState(start);
+            rewind();
+        }
+        if (target > rep->ticks) target = rep->ticks;
+        uint64_t from = tick;
+        while (tick < target) advance(game);
+        applyRestarts(game);
+        return tick - from;
+    }
+
+private:
+    void decode() {
+        uint64_t v;
+        pending = p != end;
+        if (!pending) return;
+        if (!Replay::getVarint(p, end, v)) {
+            pending = false;
+            corrupt = true;
+            return;
+        }
+        nextTick = tick + (v >> 3);
+        nextCode = v & 7;
+        if (nextCode > Replay::restartCode || nextTick > rep->ticks) {
+            pending = false;
+            corrupt = true;
+        }
+    }
+
+    const Replay* rep;
+    GameConfig start;
+    const uint8_t* p = nullptr;
+    const uint8_t* end = nullptr;
+    uint64_t tick = 0;
+    bool pending = false;
+    uint64_t nextTick = 0;
+    uint64_t nextCode = 0;
+    bool corrupt = false;
+};
@@ -0,0 +1,27 @@
+# resources/embed.cmake
+# 把一个二进制资源写成 C++ 数组, 在构建时由 CMakeLists.txt 调用:
+#   cmake -DINPUT=<文件> -DOUTPUT=<生成的 .cpp> -DSYMBOL=<名字> -P embed.cmake
+# 生成 const unsigned char <SYMBOL>Data[] 和 const std::size_t <SYMBOL>Size (见 assets.h)
+
+file(READ "${INPUT}" hex HEX)
+string(LENGTH "${hex}" digits)
+math(EXPR size "${digits} / 2")
+if(size EQUAL 0)
+    message(FATAL_ERROR "embed.cmake: ${INPUT} is empty")
+endif()
+
+# 每字节一个 0x.., 每 8 字节换行 (CMake 的正则没有 {n})
+string(REGEX REPLACE "([0-9a-f][0-9a-f])" "0x\\1," bytes "${hex}")
+string(REGEX REPLACE "((0x[0-9a-f][0-9a-f],)(0x[0-9a-f][0-9a-f],)(0x[0-9a-f][0-9a-f],)(0x[0-9a-f][0-9a-f],)(0x[0-9a-f][0-9a-f],)(0x[0-9a-f][0-9a-f],)(0x[0-9a-f][0-9a-f],)(0x[0-9a-f][0-9a-f],))" "\\1\n" bytes "${bytes}")
+
+get_filename_component(name "${INPUT}" NAME)
+file(WRITE "${OUTPUT}.tmp"
+    "// generated from ${name} by resources/embed.cmake; do not edit\n"
+    "#include <cstddef>\n\n"
+    "extern const unsigned char ${SYMBOL}Data[];\n"
+    "extern const std::size_t ${SYMBOL}Size;\n\n"
+    "alignas(16) const unsigned char ${SYMBOL}Data[] = {\n${bytes}\n};\n"
+    "const std::size_t ${SYMBOL}Size = ${size};\n")
+# 内容没变就不改时间戳, 免得重新编译
+configure_file("${OUTPUT}.tmp" "${OUTPUT}" COPYONLY)
+file(REMOVE "${OUTPUT}.tmp")
@@ -0,0 +1,110 @@
+// rng.h
+// Small-state, seedable random number generators. Both keep their whole state
+// inline (no heap, trivially copyable), so games can be cloned and replayed
+// bit-for-bit from a seed.
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+
+enum class RngKind : uint8_t { Pcg32, Xoshiro256 };
+
+inline const char* rngKindName(RngKind k) { return k == RngKind::Pcg32 ? "pcg32" : "xoshiro256"; }
+
+inline bool parseRngKind(const char* name, RngKind& out) {
+    if (!std::strcmp(name, "pcg32")) out = RngKind::Pcg32;
+    else if (!std::strcmp(name, "xoshiro256")) out = RngKind::Xoshiro256;
+    else return false;
+    return true;
+}
+
+// splitmix64, used to expand a seed into generator state
+inline uint64_t splitMix64(uint64_t& x) {
+    uint64_t z = (x += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+// PCG32 (XSH RR), 16 bytes of state; stream selects one of 2^63 sequences
+struct Pcg32 {
+    uint64_t state = 0;
+    uint64_t inc = 1;
+
+    void seed(uint64_t seed, uint64_t stream) {
+        state = 0;
+        inc = (stream << 1) | 1u;
+        next();
+        state += seed;
+        next();
+    }
+
+    uint32_t next() {
+        uint64_t old = state;
+        state = old * 6364136223846793005ull + inc;
+        uint32_t xorshifted = (uint32_t)(((old >> 18) ^ old) >> 27);
+        uint32_t rot = (uint32_t)(old >> 59);
+        return (xorshifted >> rot) | (xorshifted << ((0u - rot) & 31));
+    }
+};
+
+// xoshiro256**, 32 bytes of state
+struct Xoshiro256 {
+    uint64_t s[4] = {1, 0, 0, 0};
+
+    void seed(uint64_t seed, uint64_t stream) {
+        uint64_t x = seed ^ (stream * 0xD1B54A32D192ED03ull);
+        for (auto& w : s) w = splitMix64(x);
+    }
+
+    uint64_t next() {
+        uint64_t result = rotl(s[1] * 5, 7) * 9;
+        uint64_t t = s[1] << 17;
+        s[2] ^= s[0];
+        s[3] ^= s[1];
+        s[1] ^= s[2];
+        s[0] ^= s[3];
+        s[2] ^= t;
+        s[3] = rotl(s[3], 45);
+        return result;
+    }
+
+private:
+    static uint64_t rotl(uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+};
+
+struct RNG {
+    RngKind kind = RngKind::Pcg32;
+    Pcg32 pcg;
+    Xoshiro256 xo;
+
+    RNG() { seed(0); }
+    explicit RNG(uint64_t s, RngKind k = RngKind::Pcg32, uint64_t stream = 0) { seed(s, k, stream); }
+
+    void seed(uint64_t s, RngKind k = RngKind::Pcg32, uint64_t stream = 0) {
+        kind = k;
+        if (kind == RngKind::Pcg32) pcg.seed(s, stream);
+        else xo.seed(s, stream);
+    }
+
+    uint32_t next32() { return kind == RngKind::Pcg32 ? pcg.next() : (uint32_t)(xo.next() >> 32); }
+
+    // uniform in [0, bound): Lemire's multiply-shift, which only needs a
+    // division (and a redraw) in the rare case the low product is biased
+    uint32_t below(uint32_t bound) {
+        uint64_t m = (uint64_t)next32() * bound;
+        uint32_t low = (uint32_t)m;
+        if (low < bound) {
+            uint32_t threshold = (0u - bound) % bound;
+            while (low < threshold) {
+                m = (uint64_t)next32() * bound;
+                low = (uint32_t)m;
+            }
+        }
+        return (uint32_t)(m >> 32);
+    }
+
+    // uniform in [a, b]
+    int nextInt(int a, int b) { return a + (int)below((uint32_t)(b - a) + 1u); }
+};
@@ -0,0 +1,87 @@
+// snapshot.h
+// Compact copy of a GameState for search-based players that clone and roll
+// back states thousands of times per decision. A snapshot is a fixed header
+// (RNG state, food, score, flags, head) plus the body as 2-bit steps from each
+// segment to the next, so a 100-segment snake takes under 150 bytes.
+// Saving and loading reuse the snapshot's and the state's storage, and loading
+// costs the old plus the new snake length, not the board size. Food placement
+// after a load matches the original exactly (see OccupancyGrid).
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "game_state.h"
+
+struct SnapshotHeader {
+    RNG rng;
+    uint64_t tick = 0;
+    float moveInterval = 0.f;
+    int32_t score = 0;
+    Vec2i food;
+    Vec2i head;
+    Vec2i prevTail;
+    uint32_t length = 0;
+    uint8_t dir = 0; // Action - 1
+    uint8_t flags = 0;
+
+    static constexpr uint8_t gameOverFlag = 1;
+    static constexpr uint8_t wonFlag = 2;
+    static constexpr uint8_t growFlag = 4;
+};
+
+class GameSnapshot {
+public:
+    SnapshotHeader header;
+    std::vector<uint8_t> path; // step i (segment i to i + 1) in bits 2*(i%4) of byte i/4, as Action - 1
+
+    size_t bytes() const { return sizeof header + path.size(); }
+};
+
+// copy game into snap; a reused snapshot doesn't allocate
+inline void saveSnapshot(const GameState& game, GameSnapshot& snap) {
+    const SnakeBody& body = game.snake.body;
+    SnapshotHeader& h = snap.header;
+    h.rng = game.rng;
+    h.tick = game.tick;
+    h.moveInterval = game.cfg.moveInterval;
+    h.score = game.score;
+    h.food = game.food;
+    h.head = body.front();
+    h.prevTail = game.snake.prevTail;
+    h.length = (uint32_t)body.size();
+    h.dir = (uint8_t)((int)actionFor(game.snake.dir) - 1);
+    h.flags = (uint8_t)((game.gameOver ? SnapshotHeader::gameOverFlag : 0) | (game.won ? SnapshotHeader::wonFlag : 0) |
+                        (game.snake.growNext ? SnapshotHeader::growFlag : 0));
+
+    // segments are always neighbours, so each step is one of four directions
+    snap.path.assign((body.size() + 2) / 4, 0);
+    for (size_t i = 0; i + 1 < body.size(); ++i) {
+        unsigned code = (unsigned)actionFor(body[i + 1] - body[i]) - 1;
+        snap.path[i >> 2] |= (uint8_t)(code << ((i & 3) * 2));
+    }
+}
+
+// overwrite game with snap; game must have the board size snap was taken on
+inline void loadSnapshot(GameState& game, const GameSnapshot& snap) {
+    const SnapshotHeader& h = snap.header;
+    game.rng = h.rng;
+    game.tick = h.tick;
+    game.cfg.moveInterval = h.moveInterval;
+    game.score = h.score;
+    game.food = h.food;
+    game.gameOver = (h.flags & SnapshotHeader::gameOverFlag) != 0;
+    game.won = (h.flags & SnapshotHeader::wonFlag) != 0;
+
+    Vec2i cell = h.head;
+    size_t i = 0;
+    game.snake.assign(h.length, directionOf((Action)(h.dir + 1)), [&] {
+        Vec2i c = cell;
+        if (i + 1 < h.length) cell += directionOf((Action)(((snap.path[i >> 2] >> ((i & 3) * 2)) & 3) + 1));
+        ++i;
+        return c;
+    });
+    game.snake.growNext = (h.flags & SnapshotHeader::growFlag) != 0;
+    game.snake.prevTail = h.prevTail;
+}
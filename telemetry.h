@@ -0,0 +1,275 @@
+// telemetry.h
+// Optional per-tick telemetry for offline analysis of sessions and bot runs.
+// The game loop pushes fixed-size records into a lock-free single-producer /
+// single-consumer ring and a background thread drains it into an append-only
+// binary log, written through a memory-mapped window of the file that moves
+// along as the log grows. The producer never takes a lock or touches the
+// file: when the writer falls behind and the ring is full, record() returns
+// false and the record is counted as dropped, unless the caller asked to wait
+// (headless runs, which have no frames to miss).
+//
+// File layout: a 32-byte TelemetryHeader ("SNKT", version, RNG kind, record
+// size, board size, seed), then TelemetryRecords back to back in host byte
+// order. A crash leaves the file padded with zero records up to the mapped
+// window; tick 0 never occurs in a record, so readers stop there.
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#include "game_state.h"
+
+struct TelemetryHeader {
+    char magic[4] = {'S', 'N', 'K', 'T'};
+    uint8_t version = 1;
+    uint8_t rngKind = 0;
+    uint16_t recordSize = 0;
+    int32_t cols = 0;
+    int32_t rows = 0;
+    uint64_t seed = 0;
+    uint64_t reserved = 0;
+};
+static_assert(sizeof(TelemetryHeader) == 32, "telemetry header layout");
+
+struct TelemetryRecord {
+    uint64_t tick = 0;
+    int32_t headX = 0; // after the move, so off the board on a wall hit
+    int32_t headY = 0;
+    uint32_t length = 0;
+    int32_t score = 0;
+    float updateUs = 0.f; // this tick's step()
+    float frameMs = 0.f;  // the last finished frame, 0 without a window
+    uint32_t round = 0;   // counts restarts, since tick starts over with each
+    uint8_t result = 0;   // StepResult: Ate is food eaten, HitWall / HitSelf the death cause
+    uint8_t reserved[3] = {};
+};
+static_assert(sizeof(TelemetryRecord) == 40, "telemetry record layout");
+
+// Bounded single-producer / single-consumer queue. Each index is written by
+// one side only; the release store publishing it pairs with the other side's
+// acquire load, and the two sit on separate cache lines.
+template <class T>
+class SpscRing {
+public:
+    // capacity is rounded up to a power of two
+    explicit SpscRing(size_t capacity) {
+        size_t n = 1;
+        while (n < capacity) n <<= 1;
+        slots.resize(n);
+        mask = n - 1;
+    }
+
+    // producer side; false when full
+    bool push(const T& v) {
+        const size_t h = head.load(std::memory_order_relaxed);
+        if (h - tail.load(std::memory_order_acquire) > mask) return false;
+        slots[h & mask] = v;
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    // consumer side; up to max items into out, returns how many
+    size_t pop(T* out, size_t max) {
+        const size_t t = tail.load(std::memory_order_relaxed);
+        const size_t n = std::min(head.load(std::memory_order_acquire) - t, max);
+        for (size_t i = 0; i < n; ++i) out[i] = slots[(t + i) & mask];
+        tail.store(t + n, std::memory_order_release);
+        return n;
+    }
+
+private:
+    std::vector<T> slots;
+    size_t mask = 0;
+    alignas(64) std::atomic<size_t> head{0}; // next slot the producer fills
+    alignas(64) std::atomic<size_t> tail{0}; // next slot the consumer reads
+};
+
+// Append-only file written through a moving memory-mapped window (plain
+// buffered writes on Windows). Only the writer thread uses it.
+class MappedLog {
+public:
+    static constexpr size_t windowSize = size_t(4) << 20; // a multiple of any page size
+
+    ~MappedLog() { close(); }
+
+    bool open(const char* path) {
+#if defined(_WIN32)
+        file = std::fopen(path, "wb");
+        return file != nullptr;
+#else
+        fd = ::open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+        return fd >= 0 && mapWindow(0);
+#endif
+    }
+
+    bool append(const void* data, size_t n) {
+#if defined(_WIN32)
+        written += n;
+        return std::fwrite(data, 1, n, file) == n;
+#else
+        const uint8_t* p = (const uint8_t*)data;
+        while (n > 0) {
+            if (written == windowStart + windowSize && !mapWindow(written)) return false;
+            const size_t room = windowStart + windowSize - written;
+            const size_t k = std::min(n, room);
+            std::memcpy(window + (written - windowStart), p, k);
+            written += k;
+            p += k;
+            n -= k;
+        }
+        return true;
+#endif
+    }
+
+    // unmap and cut the file to what was written
+    void close() {
+#if defined(_WIN32)
+        if (file) std::fclose(file);
+        file = nullptr;
+#else
+        if (fd < 0) return;
+        if (window) ::munmap(window, windowSize);
+        window = nullptr;
+        (void)::ftruncate(fd, (off_t)written);
+        ::close(fd);
+        fd = -1;
+#endif
+    }
+
+    uint64_t size() const { return written; }
+
+private:
+#if !defined(_WIN32)
+    // grow the file and map [start, start + windowSize) of it
+    bool mapWindow(uint64_t start) {
+        if (window) ::munmap(window, windowSize);
+        window = nullptr;
+        if (::ftruncate(fd, (off_t)(start + windowSize)) != 0) return false;
+        void* m = ::mmap(nullptr, windowSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, (off_t)start);
+        if (m == MAP_FAILED) return false;
+        window = (uint8_t*)m;
+        windowStart = start;
+        return true;
+    }
+
+    int fd = -1;
+    uint8_t* window = nullptr;
+    uint64_t windowStart = 0;
+#else
+    FILE* file = nullptr;
+#endif
+    uint64_t written = 0;
+};
+
+class Telemetry {
+public:
+    static constexpr size_t ringCapacity = 16384; // records, a couple of seconds of a headless run
+    static constexpr size_t drainBatch = 1024;
+
+    Telemetry() : ring(ringCapacity) {}
+    ~Telemetry() { close(); }
+
+    Telemetry(const Telemetry&) = delete;
+    Telemetry& operator=(const Telemetry&) = delete;
+
+    // start a log at path for games on cfg's board; false if the file can't
+    // be made or its header can't be written
+    bool open(const char* path, const GameConfig& cfg) {
+        close();
+        if (!log.open(path)) return false;
+        TelemetryHeader h;
+        h.rngKind = (uint8_t)cfg.rngKind;
+        h.recordSize = sizeof(TelemetryRecord);
+        h.cols = cfg.cols;
+        h.rows = cfg.rows;
+        h.seed = cfg.seed;
+        if (!log.append(&h, sizeof h)) {
+            log.close();
+            return false;
+        }
+        failed = false;
+        logPath = path;
+        lastTick = 0;
+        round = 0;
+        recorded = dropped = 0;
+        stopping.store(false);
+        writer = std::thread([this] { writerLoop(); });
+        return true;
+    }
+
+    bool active() const { return writer.joinable(); }
+
+    // after game.step() returned result; never blocks unless wait is set,
+    // then it yields until the writer makes room
+    bool record(const GameState& game, StepResult result, float updateUs, float frameMs, bool wait = false) {
+        if (!active() || result == StepResult::Ended) return false;
+        if (game.tick <= lastTick) ++round; // a restart went by
+        lastTick = game.tick;
+        TelemetryRecord r;
+        r.tick = game.tick;
+        r.headX = game.snake.head().x;
+        r.headY = game.snake.head().y;
+        r.length = (uint32_t)game.snake.body.size();
+        r.score = game.score;
+        r.updateUs = updateUs;
+        r.frameMs = frameMs;
+        r.round = round;
+        r.result = (uint8_t)result;
+        while (!ring.push(r)) {
+            if (!wait) {
+                ++dropped;
+                return false;
+            }
+            std::this_thread::yield();
+        }
+        ++recorded;
+        return true;
+    }
+
+    // drain what is queued, finish the file and report on stdout
+    void close() {
+        if (!active()) return;
+        stopping.store(true, std::memory_order_release);
+        writer.join();
+        log.close();
+        std::printf("telemetry: %llu records to %s (%llu dropped)%s\n", (unsigned long long)recorded, logPath,
+                    (unsigned long long)dropped, failed ? ", write failed" : "");
+    }
+
+private:
+    void writerLoop() {
+        std::vector<TelemetryRecord> batch(drainBatch);
+        for (;;) {
+            const bool last = stopping.load(std::memory_order_acquire); // drain once more after the stop
+            size_t n;
+            while ((n = ring.pop(batch.data(), batch.size())) > 0)
+                if (!failed) failed = !log.append(batch.data(), n * sizeof(TelemetryRecord));
+            if (last) return;
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        }
+    }
+
+    SpscRing<TelemetryRecord> ring;
+    MappedLog log;             // writer thread only, while it runs
+    std::thread writer;
+    std::atomic<bool> stopping{false};
+    bool failed = false;       // writer thread only, while it runs
+    const char* logPath = "";
+    uint64_t lastTick = 0;     // producer side
+    uint32_t round = 0;
+    uint64_t recorded = 0;
+    uint64_t dropped = 0;
+};
@@ -0,0 +1,55 @@
+// test_batch_env.cpp
+// BatchEnv's structure-of-arrays environments follow GameState's rules:
+// the same actions give the same results, heads, lengths, scores and
+// occupancy, and food lands on a free cell.
+// Run: ./test_batch_env (exit status 1 on any failure); registered with ctest.
+
+#include <vector>
+
+#include "batch_env.h"
+#include "test_support.h"
+
+// BatchEnv against GameState on the same actions; each environment draws
+// food from its own stream, so GameState's food is moved to the env's
+static void testBatchRules(const GameConfig& cfg) {
+    BatchEnvOptions opts;
+    opts.autoReset = false;
+    const size_t envs = 4;
+    BatchEnv env(cfg, envs, opts);
+    std::vector<GameState> games(envs, GameState(cfg));
+    std::vector<Action> actions(envs);
+    std::vector<StepResult> results(envs);
+    RNG policy(cfg.seed ^ 0xba7c4);
+    for (size_t k = 0; k < envs; ++k) games[k].food = env.foodCell(k);
+    for (int t = 0; t < 5000; ++t) {
+        for (size_t k = 0; k < envs; ++k) actions[k] = games[k].gameOver ? Action::None : chase(games[k], policy);
+        env.step(actions.data(), results.data());
+        for (size_t k = 0; k < envs; ++k) {
+            GameState& game = games[k];
+            if (game.gameOver) {
+                REQUIRE(results[k] == StepResult::Ended);
+                continue;
+            }
+            const StepResult r = game.step(actions[k]);
+            REQUIRE(results[k] == r);
+            REQUIRE(env.done(k) == game.gameOver);
+            if (game.gameOver && r != StepResult::Won) continue; // the env leaves its head off the board too
+            REQUIRE(env.head(k) == game.snake.head());
+            REQUIRE(env.snakeLength(k) == game.snake.body.size());
+            REQUIRE(env.scoreOf(k) == game.score);
+            REQUIRE(env.tail(k) == game.snake.body.back());
+            for (int y = 0; y < cfg.rows; ++y)
+                for (int x = 0; x < cfg.cols; ++x) REQUIRE(env.occupied(k, {x, y}) == game.snake.occupies({x, y}));
+            if (r == StepResult::Ate) {
+                REQUIRE(!game.snake.occupies(env.foodCell(k))); // a free cell, as GameState would pick
+                game.food = env.foodCell(k);
+            }
+        }
+    }
+}
+
+int main() {
+    for (uint64_t seed : testSeeds)
+        for (RngKind kind : {RngKind::Pcg32, RngKind::Xoshiro256}) testBatchRules(board(20, 15, seed, kind));
+    return finish();
+}
@@ -0,0 +1,42 @@
+// test_fixed_board.cpp
+// FixedGameState follows GameState's rules: on the same seed and actions a
+// compile-time board gives the same results, heads, food, scores and
+// lengths, on a few board sizes.
+// Run: ./test_fixed_board (exit status 1 on any failure); registered with ctest.
+
+#include <memory>
+
+#include "fixed_board.h"
+#include "test_support.h"
+
+// same seed and actions on a compile-time board and on GameState
+template <int Cols, int Rows>
+static void testFixedParity(uint64_t seed, RngKind kind) {
+    const GameConfig cfg = board(Cols, Rows, seed, kind);
+    GameState game(cfg);
+    auto fixed = std::make_unique<FixedGameState<Cols, Rows>>(cfg);
+    RNG policy(seed ^ 0xf1);
+    for (int t = 0; t < 30000; ++t) {
+        if (game.gameOver) {
+            game.reset();
+            fixed->reset();
+        }
+        const Action a = chase(game, policy);
+        const StepResult r = game.step(a);
+        REQUIRE(fixed->step(a) == r);
+        REQUIRE(fixed->head() == game.snake.head());
+        REQUIRE(fixed->food == game.food);
+        REQUIRE(fixed->score == game.score);
+        REQUIRE(fixed->won == game.won);
+        if (!game.gameOver || game.won) REQUIRE(fixed->length() == game.snake.body.size()); // a death leaves the body half moved
+    }
+}
+
+int main() {
+    for (uint64_t seed : testSeeds) {
+        testFixedParity<32, 24>(seed, RngKind::Pcg32);
+        testFixedParity<64, 64>(seed, RngKind::Xoshiro256);
+        testFixedParity<100, 70>(seed, RngKind::Pcg32);
+    }
+    return finish();
+}
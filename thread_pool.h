@@ -0,0 +1,109 @@
+// thread_pool.h
+// Minimal fork-join pool: parallelFor() splits an index range into chunks that
+// the workers and the calling thread pull from, and returns when all are done.
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class ThreadPool {
+public:
+    // threads == 0 uses every hardware thread; the caller counts as one of them
+    explicit ThreadPool(unsigned threads = 0) {
+        if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+        for (unsigned i = 1; i < threads; ++i) workers.emplace_back([this] { workerLoop(); });
+    }
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (auto& t : workers) t.join();
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    unsigned size() const { return (unsigned)workers.size() + 1; }
+
+    // call fn(begin, end) over disjoint sub-ranges covering [0, n)
+    void parallelFor(size_t n, const std::function<void(size_t, size_t)>& fn) {
+        if (n == 0) return;
+        size_t chunks = std::min<size_t>(n, (size_t)size() * 4);
+        if (workers.empty() || chunks == 1) {
+            fn(0, n);
+            return;
+        }
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            // a worker that woke late for the previous job may still be leaving runChunks()
+            done.wait(lock, [&] { return active == 0; });
+            job = &fn;
+            jobSize = n;
+            jobChunks = chunks;
+            nextChunk = 0;
+            doneChunks = 0;
+            ++generation;
+        }
+        wake.notify_all();
+        runChunks();
+
+        std::unique_lock<std::mutex> lock(mutex);
+        done.wait(lock, [&] { return doneChunks == jobChunks && active == 0; });
+        job = nullptr;
+    }
+
+private:
+    void runChunks() {
+        size_t c;
+        while ((c = nextChunk.fetch_add(1)) < jobChunks) {
+            (*job)(c * jobSize / jobChunks, (c + 1) * jobSize / jobChunks);
+            if (doneChunks.fetch_add(1) + 1 == jobChunks) {
+                std::lock_guard<std::mutex> lock(mutex);
+                done.notify_one();
+            }
+        }
+    }
+
+    void workerLoop() {
+        uint64_t seen = 0;
+        for (;;) {
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wake.wait(lock, [&] { return stopping || generation != seen; });
+                if (stopping) return;
+                seen = generation;
+                ++active;
+            }
+            runChunks();
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                --active;
+            }
+            done.notify_one();
+        }
+    }
+
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable done;
+    bool stopping = false;
+    uint64_t generation = 0;
+    int active = 0; // workers currently inside runChunks()
+
+    const std::function<void(size_t, size_t)>* job = nullptr;
+    size_t jobSize = 0;
+    size_t jobChunks = 0;
+    std::atomic<size_t> nextChunk{0};
+    std::atomic<size_t> doneChunks{0};
+};